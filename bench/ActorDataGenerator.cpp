@@ -0,0 +1,111 @@
+/*
+ * ActorDataGenerator.cpp
+ * Author: Yuening YANG, Shenlang ZHOU
+ *
+ * This file shows the implementation details of ActorDataGenerator class
+ * methods, which are declared in 'ActorDataGenerator.hpp' file.
+ */
+
+#include "ActorDataGenerator.hpp"
+#include <math.h>
+#include <algorithm>
+
+using namespace std;
+
+const size_t FLUSH_SIZE = 1 << 20;  // bytes of rows written at once
+const int MAX_REDRAWS = 64;  // draws of a cast member already in the cast
+
+/* return the greatest common divisor of a and b */
+static uint64_t gcd(uint64_t a, uint64_t b) { return b ? gcd(b, a % b) : a; }
+
+/* Constructor of a generator of datasets shaped by settings */
+ActorDataGenerator::ActorDataGenerator(const Settings& settings)
+    : settings(settings),
+      generator(settings.seed),
+      castSizes(min<uint64_t>(settings.maxCast, settings.numActors),
+                settings.castExponent),
+      popularity(settings.numActors, settings.degreeExponent),
+      cast(settings.numActors, false) {
+    // a step coprime with the number of actors visits every id once
+    actorStep = 2654435761u % settings.numActors;
+    if (actorStep == 0) actorStep = 1;
+    while (gcd(actorStep, settings.numActors) != 1) actorStep++;
+
+    double weight = 1;
+    double total = 0;
+    for (int year = settings.minYear; year <= settings.maxYear; year++) {
+        total += weight;
+        yearWeights.push_back(total);
+        weight *= settings.yearGrowth;
+    }
+    for (double& cumulative : yearWeights) cumulative /= total;
+    yearWeights.back() = 1;
+}
+
+/* draw the year of a movie */
+int ActorDataGenerator::drawYear() {
+    double u = random();
+    return settings.minYear +
+           (upper_bound(yearWeights.begin(), yearWeights.end(), u) -
+            yearWeights.begin());
+}
+
+/* write the whole dataset to out, header first. return the number of rows */
+uint64_t ActorDataGenerator::write(ostream& out) {
+    auto uniform = [this]() { return random(); };
+    string buffer = "Actor/Actress\tMovie\tYear\n";
+    uint64_t numRows = 0;
+    vector<uint32_t> members;
+    for (uint64_t movie = 0; movie < settings.numMovies; movie++) {
+        string title = "\tMovie " + to_string(movie) + '\t' +
+                       to_string(drawYear()) + '\n';
+
+        // an actor drawn twice is drawn again, up to MAX_REDRAWS times
+        uint64_t castSize = castSizes.sample(uniform);
+        members.clear();
+        for (uint64_t seat = 0; seat < castSize; seat++) {
+            for (int draw = 0; draw < MAX_REDRAWS; draw++) {
+                uint32_t actor = actorOfRank(popularity.sample(uniform));
+                if (find(members.begin(), members.end(), actor) ==
+                    members.end()) {
+                    members.push_back(actor);
+                    break;
+                }
+            }
+        }
+
+        for (uint32_t actor : members) {
+            cast[actor] = true;
+            buffer += actorName(actor);
+            buffer += title;
+            numRows++;
+        }
+        if (buffer.size() >= FLUSH_SIZE) {
+            out.write(buffer.data(), buffer.size());
+            buffer.clear();
+        }
+    }
+    out.write(buffer.data(), buffer.size());
+    return numRows;
+}
+
+/* put numPairs pairs of actors cast in the written dataset in pairs */
+void ActorDataGenerator::samplePairs(uint64_t numPairs,
+                                     vector<pair<string, string>>& pairs) {
+    pairs.clear();
+    if (find(cast.begin(), cast.end(), true) == cast.end()) return;
+
+    // actors never cast are drawn again
+    auto uniform = [this]() { return random(); };
+    auto drawCast = [&]() {
+        while (true) {
+            uint32_t actor = actorOfRank(popularity.sample(uniform));
+            if (cast[actor]) return actor;
+        }
+    };
+    for (uint64_t i = 0; i < numPairs; i++) {
+        uint32_t first = drawCast();
+        uint32_t second = drawCast();
+        pairs.emplace_back(actorName(first), actorName(second));
+    }
+}
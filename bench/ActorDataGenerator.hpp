@@ -0,0 +1,83 @@
+/**
+ * ActorDataGenerator.hpp
+ * Author: Yuening YANG, Shenlang ZHOU
+ *
+ * This file declares the structure of ActorDataGenerator class, which writes
+ * synthetic actor datasets in the format read by ActorGraph.
+ */
+#ifndef ACTORDATAGENERATOR_HPP
+#define ACTORDATAGENERATOR_HPP
+
+#include <stdint.h>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "ZipfSampler.hpp"
+
+using namespace std;
+
+/**
+ * This class generates a movie dataset shaped like the real one: cast sizes
+ * follow a Zipf distribution, a few actors play in most movies (the actors
+ * of each cast are drawn by a Zipf distribution over their popularity), and
+ * the number of movies a year grows geometrically. Rows are streamed out
+ * movie by movie, so only one bit per actor is kept in memory, and the same
+ * settings and seed always give the same dataset.
+ */
+class ActorDataGenerator {
+  public:
+    /* shape of the dataset */
+    struct Settings {
+        uint32_t numActors = 100000;
+        uint64_t numMovies = 50000;
+        int maxCast = 60;               // largest cast of a movie
+        double castExponent = 1.2;      // skew of the cast sizes
+        double degreeExponent = 0.9;    // skew of the actor popularity
+        int minYear = 1920;             // year of the first movies
+        int maxYear = 2019;             // year of the last movies
+        double yearGrowth = 1.03;       // movies a year / previous year
+        unsigned long long seed = 2019;  // same seed, same dataset
+    };
+
+  private:
+    Settings settings;
+    mt19937_64 generator;
+    ZipfSampler castSizes;        // size of each cast
+    ZipfSampler popularity;       // popularity rank of each cast member
+    vector<double> yearWeights;   // cumulative share of the movies by year
+    uint64_t actorStep;           // maps popularity ranks to actor ids
+    vector<bool> cast;            // whether each actor was cast yet
+
+    /* return a double uniform in [0, 1) */
+    double random() { return (generator() >> 11) * (1.0 / (1ull << 53)); }
+
+    /* return the actor of a popularity rank, scattered over the ids so
+     * that the popular actors are not all alphabetically first */
+    uint32_t actorOfRank(uint64_t rank) const {
+        return (rank - 1) * actorStep % settings.numActors;
+    }
+
+    /* draw the year of a movie */
+    int drawYear();
+
+  public:
+    /* Constructor of a generator of datasets shaped by settings */
+    explicit ActorDataGenerator(const Settings& settings);
+
+    /* return the name of an actor */
+    static string actorName(uint32_t actor) {
+        return "Actor " + to_string(actor);
+    }
+
+    /* write the whole dataset to out, header first, as "actor, movie, year"
+     * tab-separated rows. return the number of rows */
+    uint64_t write(ostream& out);
+
+    /* put numPairs pairs of actors cast in the written dataset, drawn by
+     * popularity like the casts, in pairs. None if no actor was cast */
+    void samplePairs(uint64_t numPairs, vector<pair<string, string>>& pairs);
+};
+
+#endif  // ACTORDATAGENERATOR_HPP
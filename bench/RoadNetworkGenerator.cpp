@@ -0,0 +1,211 @@
+/*
+ * RoadNetworkGenerator.cpp
+ * Author: Yuening YANG, Shenlang ZHOU
+ *
+ * This file shows the implementation details of RoadNetworkGenerator class
+ * methods, which are declared in 'RoadNetworkGenerator.hpp' file.
+ */
+
+#include "RoadNetworkGenerator.hpp"
+#include <math.h>
+#include <algorithm>
+#include <random>
+
+using namespace std;
+
+const size_t FLUSH_SIZE = 1 << 20;  // bytes of lines written at once
+const int SEARCH_RADIUS = 2;        // cells searched around a city
+const int HIGHWAY_STEP = 10;        // cells between 2 highway exits
+
+/* write buffer to out once it is large enough, or anyway if force */
+static void flush(ostream& out, string& buffer, bool force = false) {
+    if (!force && buffer.size() < FLUSH_SIZE) return;
+    out.write(buffer.data(), buffer.size());
+    buffer.clear();
+}
+
+/* Constructor of a generator of networks shaped by settings */
+RoadNetworkGenerator::RoadNetworkGenerator(const Settings& settings)
+    : settings(settings) {
+    side = ceil(sqrt((double)settings.numCities));
+    if (side == 0) side = 1;
+    // neighbors are only searched SEARCH_RADIUS cells away
+    this->settings.jitter = min(max(settings.jitter, 0.0), 0.5);
+
+    int numHighways = settings.numHighways;
+    if (numHighways < 0) numHighways = side / 100;
+    if (side < 4 * HIGHWAY_STEP) numHighways = 0;
+    mt19937_64 generator(settings.seed);
+    for (int highway = 0; highway < numHighways; highway++) {
+        // 2 cities at least a quarter of the map apart
+        int fromX, fromY, toX, toY;
+        do {
+            uint32_t from = generator() % settings.numCities;
+            uint32_t to = generator() % settings.numCities;
+            fromX = from % side;
+            fromY = from / side;
+            toX = to % side;
+            toY = to / side;
+        } while (max(abs(toX - fromX), abs(toY - fromY)) < (int)side / 4);
+
+        // an exit every HIGHWAY_STEP cells, skipping missing cells of the
+        // last row
+        int numSteps = max(abs(toX - fromX), abs(toY - fromY)) / HIGHWAY_STEP;
+        int64_t last = -1;
+        for (int step = 0; step <= numSteps; step++) {
+            int x = lround(fromX + (double)(toX - fromX) * step / numSteps);
+            int y = lround(fromY + (double)(toY - fromY) * step / numSteps);
+            int64_t exit = (int64_t)y * side + x;
+            if (exit >= settings.numCities) continue;
+            if (last != -1) highways.emplace_back(last, exit);
+            last = exit;
+        }
+    }
+}
+
+/* return the seeded hash of a city and a salt (splitmix64) */
+uint64_t RoadNetworkGenerator::hash(uint64_t city, uint64_t salt) const {
+    uint64_t z = settings.seed + (2 * city + salt + 1) * 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+/* put the position of city in x and y */
+void RoadNetworkGenerator::position(uint32_t city, int& x, int& y) const {
+    double maxMove = settings.jitter * settings.spacing;
+    double moveX = (hash(city, 0) >> 11) * (1.0 / (1ull << 53)) * 2 - 1;
+    double moveY = (hash(city, 1) >> 11) * (1.0 / (1ull << 53)) * 2 - 1;
+    x = (city % side) * settings.spacing + settings.spacing / 2 +
+        lround(moveX * maxMove);
+    y = (city / side) * settings.spacing + settings.spacing / 2 +
+        lround(moveY * maxMove);
+}
+
+/* put the numNeighbors cities nearest to city in neighbors */
+void RoadNetworkGenerator::findNeighbors(uint32_t city,
+                                         vector<uint32_t>& neighbors) const {
+    int x, y;
+    position(city, x, y);
+    int cellX = city % side;
+    int cellY = city / side;
+
+    // (squared distance, city) of the cities of the cells around
+    vector<pair<double, uint32_t>> candidates;
+    for (int dy = -SEARCH_RADIUS; dy <= SEARCH_RADIUS; dy++) {
+        for (int dx = -SEARCH_RADIUS; dx <= SEARCH_RADIUS; dx++) {
+            int otherX = cellX + dx;
+            int otherY = cellY + dy;
+            if (otherX < 0 || otherX >= (int)side || otherY < 0) continue;
+            int64_t other = (int64_t)otherY * side + otherX;
+            if (other >= settings.numCities || other == city) continue;
+            int ox, oy;
+            position(other, ox, oy);
+            double distance = pow(ox - x, 2) + pow(oy - y, 2);
+            candidates.emplace_back(distance, other);
+        }
+    }
+
+    size_t count = min<size_t>(settings.numNeighbors, candidates.size());
+    partial_sort(candidates.begin(), candidates.begin() + count,
+                 candidates.end());
+    neighbors.clear();
+    for (size_t i = 0; i < count; i++) {
+        neighbors.push_back(candidates[i].second);
+    }
+}
+
+/* call visit(from, to, weightFactor) once for every road */
+template <typename Visit>
+void RoadNetworkGenerator::forEachRoad(Visit visit) const {
+    vector<uint32_t> neighbors;
+    vector<uint32_t> theirs;
+    for (uint32_t city = 0; city < settings.numCities; city++) {
+        findNeighbors(city, neighbors);
+        for (uint32_t next : neighbors) {
+            // the road was visited from next if city is among its neighbors
+            if (next < city) {
+                findNeighbors(next, theirs);
+                if (find(theirs.begin(), theirs.end(), city) != theirs.end()) {
+                    continue;
+                }
+            }
+            visit(city, next, 1.0);
+        }
+    }
+    for (const auto& road : highways) {
+        visit(road.first, road.second, settings.highwaySpeed);
+    }
+}
+
+/* write the network in the cityxy and citypairs formats */
+uint64_t RoadNetworkGenerator::writeCityFiles(ostream& xyOut,
+                                              ostream& pairOut) const {
+    string buffer;
+    for (uint32_t city = 0; city < settings.numCities; city++) {
+        int x, y;
+        position(city, x, y);
+        buffer += cityName(city) + ' ' + to_string(x) + ' ' + to_string(y) +
+                  '\n';
+        flush(xyOut, buffer);
+    }
+    flush(xyOut, buffer, true);
+
+    uint64_t numRoads = 0;
+    forEachRoad([&](uint32_t from, uint32_t to, double) {
+        buffer += cityName(from) + ' ' + cityName(to) + '\n';
+        flush(pairOut, buffer);
+        numRoads++;
+    });
+    flush(pairOut, buffer, true);
+    return numRoads;
+}
+
+/* write the network as a DIMACS graph and DIMACS coordinates */
+uint64_t RoadNetworkGenerator::writeDimacs(ostream& grOut,
+                                           ostream& coOut) const {
+    // the header needs the number of arcs first
+    uint64_t numRoads = 0;
+    forEachRoad([&](uint32_t, uint32_t, double) { numRoads++; });
+
+    string buffer = "p sp " + to_string(settings.numCities) + ' ' +
+                    to_string(2 * numRoads) + '\n';
+    forEachRoad([&](uint32_t from, uint32_t to, double weightFactor) {
+        int fromX, fromY, toX, toY;
+        position(from, fromX, fromY);
+        position(to, toX, toY);
+        double length = sqrt(pow(toX - fromX, 2) + pow(toY - fromY, 2));
+        string weight = to_string(max(1LL, llround(length * weightFactor)));
+        buffer += "a " + cityName(from) + ' ' + cityName(to) + ' ' + weight +
+                  '\n';
+        buffer += "a " + cityName(to) + ' ' + cityName(from) + ' ' + weight +
+                  '\n';
+        flush(grOut, buffer);
+    });
+    flush(grOut, buffer, true);
+
+    buffer = "p aux sp co " + to_string(settings.numCities) + '\n';
+    for (uint32_t city = 0; city < settings.numCities; city++) {
+        int x, y;
+        position(city, x, y);
+        buffer += "v " + cityName(city) + ' ' + to_string(x) + ' ' +
+                  to_string(y) + '\n';
+        flush(coOut, buffer);
+    }
+    flush(coOut, buffer, true);
+    return numRoads;
+}
+
+/* write numQueries random "start end" queries, one per line */
+void RoadNetworkGenerator::writeQueries(ostream& out,
+                                        uint64_t numQueries) const {
+    mt19937_64 generator(settings.seed + 1);
+    string buffer;
+    for (uint64_t i = 0; i < numQueries; i++) {
+        uint32_t start = generator() % settings.numCities;
+        uint32_t end = generator() % settings.numCities;
+        buffer += cityName(start) + ' ' + cityName(end) + '\n';
+        flush(out, buffer);
+    }
+    flush(out, buffer, true);
+}
@@ -0,0 +1,82 @@
+/**
+ * RoadNetworkGenerator.hpp
+ * Author: Yuening YANG, Shenlang ZHOU
+ *
+ * This file declares the structure of RoadNetworkGenerator class, which
+ * writes synthetic road networks in the formats read by CityGraph.
+ */
+#ifndef ROADNETWORKGENERATOR_HPP
+#define ROADNETWORKGENERATOR_HPP
+
+#include <stdint.h>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+/**
+ * This class generates a planar-ish road network: one city per cell of a
+ * square grid, moved randomly within its cell, is linked to its nearest
+ * neighbors, and a few highways cross the map in straight lines, linking
+ * cities every few cells. The position of a city is a hash of its id and the
+ * seed, and its neighbors are found among the cells around it, so nothing
+ * but the highways is kept in memory and tens of millions of cities fit.
+ * City i is named i + 1 in every format, like in DIMACS files, so the same
+ * query file works for both formats.
+ */
+class RoadNetworkGenerator {
+  public:
+    /* shape of the network */
+    struct Settings {
+        uint32_t numCities = 100000;
+        int numNeighbors = 3;            // nearest cities linked to a city
+        int spacing = 100;               // side of a grid cell
+        double jitter = 0.35;            // largest move, in cells
+        int numHighways = -1;            // -1 for one per 100 grid columns
+        double highwaySpeed = 0.5;       // DIMACS weight / length of highways
+        unsigned long long seed = 2019;  // same seed, same network
+    };
+
+  private:
+    Settings settings;
+    uint32_t side;  // cells in a row of the grid
+    vector<pair<uint32_t, uint32_t>> highways;  // roads of the highways
+
+    /* return the seeded hash of a city and a salt */
+    uint64_t hash(uint64_t city, uint64_t salt) const;
+
+    /* put the numNeighbors cities nearest to city in neighbors */
+    void findNeighbors(uint32_t city, vector<uint32_t>& neighbors) const;
+
+    /* call visit(from, to, weightFactor) once for every road, first the
+     * local roads by increasing from, then the highways */
+    template <typename Visit>
+    void forEachRoad(Visit visit) const;
+
+  public:
+    /* Constructor of a generator of networks shaped by settings */
+    explicit RoadNetworkGenerator(const Settings& settings);
+
+    /* return the name of a city */
+    static string cityName(uint32_t city) { return to_string(city + 1); }
+
+    /* put the position of city in x and y */
+    void position(uint32_t city, int& x, int& y) const;
+
+    /* write the network in the cityxy and citypairs formats. return the
+     * number of roads */
+    uint64_t writeCityFiles(ostream& xyOut, ostream& pairOut) const;
+
+    /* write the network as a DIMACS graph, both arcs of each road weighing
+     * its rounded length times the highway speed on highways, and DIMACS
+     * coordinates. return the number of roads */
+    uint64_t writeDimacs(ostream& grOut, ostream& coOut) const;
+
+    /* write numQueries random "start end" queries, one per line, as read by
+     * navigationsystem */
+    void writeQueries(ostream& out, uint64_t numQueries) const;
+};
+
+#endif  // ROADNETWORKGENERATOR_HPP
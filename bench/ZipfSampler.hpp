@@ -0,0 +1,79 @@
+/**
+ * ZipfSampler.hpp
+ * Author: Yuening YANG, Shenlang ZHOU
+ *
+ * This file declares the ZipfSampler class, which draws ranks following a
+ * Zipf distribution in constant time and memory.
+ */
+#ifndef ZIPFSAMPLER_HPP
+#define ZIPFSAMPLER_HPP
+
+#include <math.h>
+#include <stdint.h>
+
+/**
+ * This class draws ranks k in [1, n] with probability proportional to
+ * 1 / k^exponent by rejection-inversion (Hormann and Derflinger), so it needs
+ * no table even for billions of ranks. Random numbers come from random(), a
+ * double uniform in [0, 1), so the same seed gives the same ranks on every
+ * platform.
+ */
+class ZipfSampler {
+  private:
+    uint64_t n;         // largest rank
+    double exponent;    // larger is more skewed, 0 is uniform
+    double hIntegralX1;  // bounds of the area the points are drawn from
+    double hIntegralN;
+    double squeeze;  // points this close to their rank are always accepted
+
+    /* log1p(x) / x, exact near 0 */
+    static double helper1(double x) {
+        if (fabs(x) > 1e-8) return log1p(x) / x;
+        return 1 - x * (0.5 - x * (1.0 / 3 - 0.25 * x));
+    }
+
+    /* expm1(x) / x, exact near 0 */
+    static double helper2(double x) {
+        if (fabs(x) > 1e-8) return expm1(x) / x;
+        return 1 + x * 0.5 * (1 + x / 3 * (1 + 0.25 * x));
+    }
+
+    /* the unnormalized density 1 / x^exponent */
+    double h(double x) const { return exp(-exponent * log(x)); }
+
+    /* an antiderivative of h */
+    double hIntegral(double x) const {
+        double logX = log(x);
+        return helper2((1 - exponent) * logX) * logX;
+    }
+
+    /* the inverse of hIntegral */
+    double hIntegralInverse(double x) const {
+        double t = x * (1 - exponent);
+        if (t < -1) t = -1;  // rounding could give a log of a negative
+        return exp(helper1(t) * x);
+    }
+
+  public:
+    /* Constructor of a sampler of ranks in [1, n] */
+    ZipfSampler(uint64_t n, double exponent) : n(n), exponent(exponent) {
+        hIntegralX1 = hIntegral(1.5) - 1;
+        hIntegralN = hIntegral(n + 0.5);
+        squeeze = 2 - hIntegralInverse(hIntegral(2.5) - h(2));
+    }
+
+    /* draw a rank, with random() returning doubles uniform in [0, 1) */
+    template <typename Random>
+    uint64_t sample(Random& random) const {
+        while (true) {
+            double u = hIntegralN + random() * (hIntegralX1 - hIntegralN);
+            double x = hIntegralInverse(u);
+            uint64_t k = x + 0.5;
+            if (k < 1) k = 1;
+            if (k > n) k = n;
+            if (k - x <= squeeze || u >= hIntegral(k + 0.5) - h(k)) return k;
+        }
+    }
+};
+
+#endif  // ZIPFSAMPLER_HPP
@@ -0,0 +1,83 @@
+/**
+ * This file implements a program that generates a synthetic actor dataset,
+ * and optionally a file of actor pairs to query it with
+ *
+ * Author Yuening Yang
+ */
+#include <fstream>
+#include <iostream>
+
+#include "ActorDataGenerator.hpp"
+#include "cxxopts.hpp"
+
+using namespace std;
+
+/* Main program that runs the generator */
+int main(int argc, char* argv[]) {
+    cxxopts::Options options(
+        "./actorgen",
+        "Generate an actor dataset with power-law cast sizes and actor "
+        "degrees.");
+    options.positional_help("./path_to_output_file");
+
+    ActorDataGenerator::Settings settings;
+    string outFileName, pairFileName;
+    uint64_t numPairs = 1000;
+    options.add_options()("output", "", cxxopts::value<string>(outFileName))(
+        "actors", "Number of actors",
+        cxxopts::value<uint32_t>(settings.numActors))(
+        "movies", "Number of movies",
+        cxxopts::value<uint64_t>(settings.numMovies))(
+        "max-cast", "Largest cast of a movie",
+        cxxopts::value<int>(settings.maxCast))(
+        "cast-exponent", "Zipf exponent of the cast sizes",
+        cxxopts::value<double>(settings.castExponent))(
+        "degree-exponent",
+        "Zipf exponent of the actor popularity, which shapes their degrees",
+        cxxopts::value<double>(settings.degreeExponent))(
+        "min-year", "Year of the first movies",
+        cxxopts::value<int>(settings.minYear))(
+        "max-year", "Year of the last movies",
+        cxxopts::value<int>(settings.maxYear))(
+        "year-growth", "Number of movies of a year over the previous year",
+        cxxopts::value<double>(settings.yearGrowth))(
+        "seed", "Seed of the random numbers, the same seed gives the same "
+        "dataset",
+        cxxopts::value<unsigned long long>(settings.seed))(
+        "pairs", "Also write actor pairs in the format of pathfinder to this "
+        "file",
+        cxxopts::value<string>(pairFileName))(
+        "num-pairs", "Number of actor pairs",
+        cxxopts::value<uint64_t>(numPairs))("h, help", "Print help and exit");
+
+    options.parse_positional({"output"});
+    auto userOptions = options.parse(argc, argv);
+
+    // if invalid format or using help flag, then print help and exit
+    if (userOptions.count("help") || outFileName.empty() ||
+        settings.numActors < 1 || settings.maxCast < 1 ||
+        settings.minYear > settings.maxYear) {
+        cout << options.help({""}) << std::endl;
+        exit(0);
+    }
+
+    ActorDataGenerator generator(settings);
+    ofstream outFile(outFileName);
+    uint64_t numRows = generator.write(outFile);
+    outFile.close();
+    if (!outFile) {
+        cerr << "Failed to write " << outFileName << "!\n";
+        return 1;
+    }
+    cout << "Wrote " << numRows << " rows to " << outFileName << endl;
+
+    if (!pairFileName.empty()) {
+        vector<pair<string, string>> pairs;
+        generator.samplePairs(numPairs, pairs);
+        ofstream pairFile(pairFileName);
+        pairFile << "Actor1/Actress1\tActor2/Actress2\n";
+        for (const auto& actors : pairs) {
+            pairFile << actors.first << '\t' << actors.second << '\n';
+        }
+    }
+}
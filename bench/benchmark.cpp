@@ -0,0 +1,191 @@
+/**
+ * This file implements a program that times the main operations of the actor
+ * and city graphs on synthetic datasets of several sizes
+ *
+ * Author Yuening Yang
+ */
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ActorDataGenerator.hpp"
+#include "ActorGraph.hpp"
+#include "CityGraph.hpp"
+#include "RoadNetworkGenerator.hpp"
+#include "cxxopts.hpp"
+
+using namespace std;
+
+const unsigned int BENCH_SEED = 2019;  // seed of the datasets and queries
+const int NUM_QUERIES = 100;           // path queries timed per run
+const int NUM_LINK_QUERIES = 10;       // link predictions timed per run
+
+/**
+ * Time numRuns runs of operation, each doing numOps operations, after an
+ * untimed warm-up run, and print one row of results: the median time of a
+ * run, the fastest one, the median absolute deviation in percent of the
+ * median, and the throughput and latency of the median run. cleanup is
+ * called untimed after every run.
+ */
+void runCase(const string& name, int size, int numOps, int numRuns,
+             const function<void()>& operation,
+             const function<void()>& cleanup = [] {}) {
+    operation();
+    cleanup();
+
+    vector<double> seconds;
+    for (int run = 0; run < numRuns; run++) {
+        auto begin = chrono::steady_clock::now();
+        operation();
+        auto end = chrono::steady_clock::now();
+        cleanup();
+        seconds.push_back(chrono::duration<double>(end - begin).count());
+    }
+
+    sort(seconds.begin(), seconds.end());
+    double median = seconds[seconds.size() / 2];
+    vector<double> deviations;
+    for (double time : seconds) deviations.push_back(fabs(time - median));
+    sort(deviations.begin(), deviations.end());
+    double spread = median > 0 ? deviations[deviations.size() / 2] / median : 0;
+
+    cout << left << setw(24) << name << right << setw(10) << size << fixed
+         << setprecision(3) << setw(12) << median * 1e3 << setw(12)
+         << seconds[0] * 1e3 << setprecision(1) << setw(8) << spread * 100
+         << '%' << setprecision(0) << setw(14) << numOps / median
+         << setprecision(2) << setw(12) << median * 1e6 / numOps << endl;
+}
+
+/* time the actor graph operations on a dataset of numActors actors */
+void benchActorGraph(const string& dataDir, int numActors, int numRuns) {
+    string filename = dataDir + "/bench_actors_" + to_string(numActors) +
+                      ".tsv";
+    ActorDataGenerator::Settings settings;
+    settings.numActors = numActors;
+    settings.numMovies = numActors / 2;
+    ActorDataGenerator generator(settings);
+    ofstream out(filename);
+    uint64_t numRows = generator.write(out);
+    out.close();
+
+    vector<pair<string, string>> queries;
+    generator.samplePairs(NUM_QUERIES, queries);
+    if (queries.empty()) return;
+
+    ActorGraph* graph = 0;
+    runCase("actor loadFromFile", numActors, numRows, numRuns,
+            [&]() {
+                graph = new ActorGraph();
+                graph->loadFromFile(filename.c_str(), false);
+            },
+            [&]() { delete graph; });
+
+    for (bool weighted : {false, true}) {
+        ActorGraph loaded;
+        loaded.loadFromFile(filename.c_str(), weighted);
+        runCase(weighted ? "actor find_path w" : "actor find_path u",
+                numActors, NUM_QUERIES, numRuns, [&]() {
+                    ostringstream out;
+                    for (const auto& query : queries) {
+                        loaded.find_path(query.first, query.second, out,
+                                         weighted);
+                    }
+                });
+    }
+
+    ActorGraph unweighted;
+    unweighted.loadFromFile(filename.c_str(), false);
+    runCase("actor predictlink", numActors, NUM_LINK_QUERIES, numRuns, [&]() {
+        ostringstream out1, out2;
+        for (int q = 0; q < NUM_LINK_QUERIES; q++) {
+            unweighted.predictlink(queries[q].first, out1, out2);
+        }
+    });
+
+    ActorGraph weighted;
+    weighted.loadFromFile(filename.c_str(), true);
+    runCase("actor findMST", numActors, 1, numRuns, [&]() {
+        ostringstream out;
+        weighted.findMST(out, true);
+    });
+}
+
+/* time the city graph operations on a dataset of numCities cities */
+void benchCityGraph(const string& dataDir, int numCities, int numRuns) {
+    string xyFile = dataDir + "/bench_cityxy_" + to_string(numCities) + ".txt";
+    string pairFile =
+        dataDir + "/bench_citypairs_" + to_string(numCities) + ".txt";
+    RoadNetworkGenerator::Settings settings;
+    settings.numCities = numCities;
+    RoadNetworkGenerator generator(settings);
+    ofstream xyOut(xyFile);
+    ofstream pairOut(pairFile);
+    uint64_t numRoads = generator.writeCityFiles(xyOut, pairOut);
+    xyOut.close();
+    pairOut.close();
+
+    mt19937 random(BENCH_SEED);
+    vector<pair<string, string>> queries;
+    for (int q = 0; q < NUM_QUERIES; q++) {
+        queries.emplace_back(
+            RoadNetworkGenerator::cityName(random() % numCities),
+            RoadNetworkGenerator::cityName(random() % numCities));
+    }
+
+    CityGraph* graph = 0;
+    runCase("city loadFromFile", numCities, numCities + numRoads, numRuns,
+            [&]() {
+                graph = new CityGraph();
+                graph->loadFromFile(xyFile.c_str(), pairFile.c_str());
+            },
+            [&]() { delete graph; });
+
+    CityGraph loaded;
+    loaded.loadFromFile(xyFile.c_str(), pairFile.c_str());
+    runCase("city find_path", numCities, NUM_QUERIES, numRuns, [&]() {
+        ostringstream out;
+        for (const auto& query : queries) {
+            loaded.find_path(query.first, query.second, out);
+        }
+    });
+}
+
+/* Main program that runs the benchmarks */
+int main(int argc, char* argv[]) {
+    cxxopts::Options options(
+        "./benchmark",
+        "Time the graph operations on synthetic datasets of several sizes.");
+
+    vector<int> sizes;
+    int numRuns = 7;
+    string dataDir = ".";
+    options.add_options()(
+        "sizes", "Comma-separated numbers of actors and of cities",
+        cxxopts::value<vector<int>>(sizes)->default_value("1000,5000"))(
+        "runs", "Timed runs of each case, after a warm-up run",
+        cxxopts::value<int>(numRuns))(
+        "data-dir", "Directory the datasets are written to",
+        cxxopts::value<string>(dataDir))("h, help", "Print help and exit");
+    auto userOptions = options.parse(argc, argv);
+
+    if (userOptions.count("help") || numRuns < 1) {
+        cout << options.help({""}) << std::endl;
+        exit(0);
+    }
+
+    cout << left << setw(24) << "case" << right << setw(10) << "size"
+         << setw(12) << "median ms" << setw(12) << "min ms" << setw(9)
+         << "mad" << setw(14) << "ops/s" << setw(12) << "us/op" << endl;
+    for (int size : sizes) {
+        benchActorGraph(dataDir, size, numRuns);
+        benchCityGraph(dataDir, size, numRuns);
+    }
+}
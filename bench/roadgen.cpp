@@ -0,0 +1,81 @@
+/**
+ * This file implements a program that generates a synthetic road network,
+ * and a file of random queries on it
+ *
+ * Author Yuening Yang
+ */
+#include <fstream>
+#include <iostream>
+
+#include "RoadNetworkGenerator.hpp"
+#include "cxxopts.hpp"
+
+using namespace std;
+
+/* Main program that runs the generator */
+int main(int argc, char* argv[]) {
+    cxxopts::Options options(
+        "./roadgen",
+        "Generate a road network of cities linked to their nearest "
+        "neighbors, crossed by highways.");
+    options.positional_help("./path_prefix_of_output_files");
+
+    RoadNetworkGenerator::Settings settings;
+    string prefix;
+    string format = "both";
+    uint64_t numQueries = 1000;
+    options.add_options()("prefix", "", cxxopts::value<string>(prefix))(
+        "cities", "Number of cities",
+        cxxopts::value<uint32_t>(settings.numCities))(
+        "neighbors", "Number of nearest cities each city is linked to",
+        cxxopts::value<int>(settings.numNeighbors))(
+        "spacing", "Side of the grid cell of a city",
+        cxxopts::value<int>(settings.spacing))(
+        "jitter", "Largest move of a city within its cell, in cells, up to 0.5",
+        cxxopts::value<double>(settings.jitter))(
+        "highways", "Number of highways, one per 100 grid columns by default",
+        cxxopts::value<int>(settings.numHighways))(
+        "highway-speed", "DIMACS weight of a highway road over its length",
+        cxxopts::value<double>(settings.highwaySpeed))(
+        "seed", "Seed of the random numbers, the same seed gives the same "
+        "network",
+        cxxopts::value<unsigned long long>(settings.seed))(
+        "format",
+        "Files written: city (<prefix>xy.txt and <prefix>pairs.txt), dimacs "
+        "(<prefix>.gr and <prefix>.co) or both",
+        cxxopts::value<string>(format))(
+        "queries", "Number of random queries written to <prefix>query.txt",
+        cxxopts::value<uint64_t>(numQueries))("h, help", "Print help and exit");
+
+    options.parse_positional({"prefix"});
+    auto userOptions = options.parse(argc, argv);
+
+    // if invalid format or using help flag, then print help and exit
+    bool cityFormat = format == "city" || format == "both";
+    bool dimacsFormat = format == "dimacs" || format == "both";
+    if (userOptions.count("help") || prefix.empty() ||
+        (!cityFormat && !dimacsFormat) || settings.numCities < 1 ||
+        settings.numNeighbors < 1 || settings.spacing < 1) {
+        cout << options.help({""}) << std::endl;
+        exit(0);
+    }
+
+    RoadNetworkGenerator generator(settings);
+    uint64_t numRoads = 0;
+    if (cityFormat) {
+        ofstream xyFile(prefix + "xy.txt");
+        ofstream pairFile(prefix + "pairs.txt");
+        numRoads = generator.writeCityFiles(xyFile, pairFile);
+    }
+    if (dimacsFormat) {
+        ofstream grFile(prefix + ".gr");
+        ofstream coFile(prefix + ".co");
+        numRoads = generator.writeDimacs(grFile, coFile);
+    }
+    if (numQueries > 0) {
+        ofstream queryFile(prefix + "query.txt");
+        generator.writeQueries(queryFile, numQueries);
+    }
+    cout << "Wrote " << settings.numCities << " cities and " << numRoads
+         << " roads" << endl;
+}
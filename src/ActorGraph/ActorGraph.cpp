@@ -9,22 +9,26 @@
 
 #include "ActorGraph.hpp"
 #include <algorithm>
+#include <atomic>
 #include <fstream>
 #include <iostream>
 #include <queue>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 using namespace std;
 
 const int WEIGHT_HELPER = 2020;     // current year + 1
 const int LINK_PREDICTOR_SIZE = 4;  // number of actors wanted in linkpredictor
+const int DEFAULT_LANDMARKS = 16;   // number of landmarks built on demand
 
 /**
  * Constructor of the Actor graph
  */
-ActorGraph::ActorGraph(void) {}
+ActorGraph::ActorGraph(void)
+    : componentsBuilt(false), numComponents(0), landmarks(0), hopLabels(0) {}
 
 /**
  * Destructor of the Actor graph
@@ -36,11 +40,35 @@ ActorGraph::~ActorGraph() {
     for (auto itr = movies.begin(); itr != movies.end(); itr++) {
         delete itr->second;
     }
+    delete landmarks;
+    delete hopLabels;
 }
 
 /* find the shortest path of the graph */
 void ActorGraph::find_path(string startActorName, string endActorName,
                            ostream& outFile, bool use_weighted_edges) {
+    NoCounting counter;
+    findActorPath(startActorName, endActorName, outFile, use_weighted_edges,
+                  counter);
+}
+
+/* find the shortest path of the graph and put the effort of the search in
+ * stats */
+void ActorGraph::find_path(string startActorName, string endActorName,
+                           ostream& outFile, bool use_weighted_edges,
+                           SearchStats& stats) {
+    Counting counter;
+    findActorPath(startActorName, endActorName, outFile, use_weighted_edges,
+                  counter);
+    stats = counter.stats;
+}
+
+/* find the shortest path of the graph, counting the effort of the search
+ * with counter */
+template <typename Counter>
+void ActorGraph::findActorPath(const string& startActorName,
+                               const string& endActorName, ostream& outFile,
+                               bool use_weighted_edges, Counter& counter) {
     // if the start and end are the same actor, then output an empty line
     if (startActorName == endActorName) {
         outFile << endl;
@@ -56,6 +84,46 @@ void ActorGraph::find_path(string startActorName, string endActorName,
     ActorNode* startActor = actors.at(startActorName);
     ActorNode* endActor = actors.at(endActorName);
 
+    // if in different components, there is no path between them
+    if (!componentsBuilt) buildComponents();
+    if (startActor->component != endActor->component) {
+        outFile << endl;
+        return;
+    }
+
+    if (!use_weighted_edges && hopLabels) {
+        // walk from the start actor, always to a co-star one hop closer to
+        // the end actor according to the labels. Labels that disagree with
+        // the graph stop the walk short of the end actor, and the BFS below
+        // answers instead
+        int hops = hopLabels->query(startActor->id, endActor->id);
+        string path = "(" + startActor->name + ")";
+        ActorNode* actor = startActor;
+        while (hops > 0) {
+            bool stepped = false;
+            counter.settle();
+            for (MovieEdge* movie : actor->movies) {
+                counter.scan();
+                for (const string& nextActorName : movie->actors) {
+                    ActorNode* next = actors.at(nextActorName);
+                    if (hopLabels->query(next->id, endActor->id) == hops - 1) {
+                        path += "--[" + movie->key + "]-->(" + next->name + ")";
+                        actor = next;
+                        stepped = true;
+                        break;
+                    }
+                }
+                if (stepped) break;
+            }
+            if (!stepped) break;
+            hops--;
+        }
+        if (actor == endActor) {
+            outFile << path << endl;
+            return;
+        }
+    }
+
     // reset the graph
     for (auto itr = actors.begin(); itr != actors.end(); itr++) {
         itr->second->dist = INT32_MAX;
@@ -64,20 +132,78 @@ void ActorGraph::find_path(string startActorName, string endActorName,
     }
     startActor->dist = 0;
 
-    if (use_weighted_edges) {
+    if (use_weighted_edges && landmarks) {
+        // use A* with landmark lower bounds to find the shortest path in a
+        // weighted graph. Actors with lower (f = dist + bound) value have
+        // higher priority
+        priority_queue<pair<unsigned int, ActorNode*>,
+                       vector<pair<unsigned int, ActorNode*>>,
+                       greater<pair<unsigned int, ActorNode*>>>
+            toExplore;
+        toExplore.emplace(landmarks->lowerBound(startActor->id, endActor->id),
+                          startActor);
+        counter.push(toExplore.size());
+
+        while (!toExplore.empty()) {
+            ActorNode* current = toExplore.top().second;
+            unsigned int currentF = toExplore.top().first;
+            // if get target end actor, break
+            if (current == endActor) break;
+            toExplore.pop();
+            counter.pop();
+            // skip outdated entries
+            if (currentF >
+                current->dist + landmarks->lowerBound(current->id,
+                                                      endActor->id)) {
+                counter.stalePop();
+                continue;
+            }
+            counter.settle();
+            for (MovieEdge* nextEdge : current->movies) {
+                counter.scan();
+                unsigned int newDist = current->dist + nextEdge->weight;
+                for (const string& nextActorName : nextEdge->actors) {
+                    ActorNode* next = actors.at(nextActorName);
+                    if (newDist < next->dist) {
+                        next->dist = newDist;
+                        next->prevNode = current;
+                        next->prevEdge = nextEdge;
+                        // push it to the priority queue
+                        toExplore.emplace(
+                            newDist +
+                                landmarks->lowerBound(next->id, endActor->id),
+                            next);
+                        counter.push(toExplore.size());
+                    }
+                }
+            }
+        }
+    } else if (use_weighted_edges) {
         // use Dijkstra's Algorithm to find the shortest path in a weighted
         // graph.
         priority_queue<ActorNode*, vector<ActorNode*>, ActorNode::DistComp>
             toExplore;
         toExplore.push(startActor);
+        counter.push(toExplore.size());
+        // actors settled by this query, an actor pushed again when its dist
+        // drops is popped once more
+        unordered_set<ActorNode*> settled;
 
         while (!toExplore.empty()) {
             ActorNode* current = toExplore.top();
             // if get target end actor, break
             if (current == endActor) break;
             toExplore.pop();
+            counter.pop();
+            // skip outdated entries
+            if (!settled.insert(current).second) {
+                counter.stalePop();
+                continue;
+            }
+            counter.settle();
             for (MovieEdge* nextEdge : current->movies) {
-                int newDist = current->dist + nextEdge->weight;
+                counter.scan();
+                unsigned int newDist = current->dist + nextEdge->weight;
                 for (string nextActorName : nextEdge->actors) {
                     ActorNode* next = actors.at(nextActorName);
                     if (newDist < next->dist) {
@@ -86,6 +212,7 @@ void ActorGraph::find_path(string startActorName, string endActorName,
                         next->prevEdge = nextEdge;
                         // push it to the priority queue
                         toExplore.push(next);
+                        counter.push(toExplore.size());
                     }
                 }
             }
@@ -94,13 +221,17 @@ void ActorGraph::find_path(string startActorName, string endActorName,
         // use BFS to find the shortest path in an unweighted graph
         queue<ActorNode*> toExplore;
         toExplore.push(startActor);
+        counter.push(toExplore.size());
         // build path
         while (!toExplore.empty()) {
             ActorNode* current = toExplore.front();
             // if get target end actor, break
             if (current == endActor) break;
             toExplore.pop();
+            counter.pop();
+            counter.settle();
             for (MovieEdge* nextEdge : current->movies) {
+                counter.scan();
                 for (string nextActorName : nextEdge->actors) {
                     ActorNode* next = actors.at(nextActorName);
                     if (next->dist == INT32_MAX) {
@@ -109,6 +240,7 @@ void ActorGraph::find_path(string startActorName, string endActorName,
                         next->prevEdge = nextEdge;
                         // push it to the queue
                         toExplore.push(next);
+                        counter.push(toExplore.size());
                     }
                 }
             }
@@ -136,6 +268,24 @@ void ActorGraph::find_path(string startActorName, string endActorName,
  */
 void ActorGraph::predictlink(string targetActorName, ostream& outFile1,
                              ostream& outFile2) {
+    NoCounting counter;
+    rankLinks(targetActorName, outFile1, outFile2, counter);
+}
+
+/* predict possible future collaberation of other actors and the given actor,
+ * and put the effort of the search in stats */
+void ActorGraph::predictlink(string targetActorName, ostream& outFile1,
+                             ostream& outFile2, SearchStats& stats) {
+    Counting counter;
+    rankLinks(targetActorName, outFile1, outFile2, counter);
+    stats = counter.stats;
+}
+
+/* predict possible future collaberation of other actors and the given actor,
+ * counting the effort of the search with counter */
+template <typename Counter>
+void ActorGraph::rankLinks(const string& targetActorName, ostream& outFile1,
+                           ostream& outFile2, Counter& counter) {
     // if actor does not exist in the graph, output an empty line
     if (actors.count(targetActorName) == 0) {
         outFile1 << endl;
@@ -154,6 +304,7 @@ void ActorGraph::predictlink(string targetActorName, ostream& outFile1,
     unordered_set<ActorNode*> collaberated;
     unordered_set<ActorNode*> not_collaberated;
     for (auto movie : targetActor->movies) {
+        counter.scan();
         for (string actorName : movie->actors) {
             // get actors who have collaberated with our target actor
             collaberated.insert(actors.at(actorName));
@@ -169,7 +320,9 @@ void ActorGraph::predictlink(string targetActorName, ostream& outFile1,
             }
             // get actors who have collaberated with our target actor
             ActorNode* firstActor = actors.at(firstActorName);
+            counter.settle();
             for (auto movie2 : firstActor->movies) {
+                counter.scan();
                 for (string secondActorName : movie2->actors) {
                     if (secondActorName == targetActorName ||
                         secondActorName == firstActorName) {
@@ -200,12 +353,15 @@ void ActorGraph::predictlink(string targetActorName, ostream& outFile1,
         }
         if (collaberated_pq.size() < LINK_PREDICTOR_SIZE) {
             collaberated_pq.push(*itr);
+            counter.push(collaberated_pq.size());
         } else {
             if (((*itr)->priority > collaberated_pq.top()->priority) ||
                 ((*itr)->priority == collaberated_pq.top()->priority &&
                  (*itr)->name < collaberated_pq.top()->name)) {
                 collaberated_pq.pop();
                 collaberated_pq.push(*itr);
+                counter.pop();
+                counter.push(collaberated_pq.size());
             }
         }
     }
@@ -213,6 +369,7 @@ void ActorGraph::predictlink(string targetActorName, ostream& outFile1,
     while (collaberated_pq.size() > 0) {
         output1 = collaberated_pq.top()->name + "\t" + output1;
         collaberated_pq.pop();
+        counter.pop();
     }
     outFile1 << output1 << endl;
 
@@ -224,12 +381,15 @@ void ActorGraph::predictlink(string targetActorName, ostream& outFile1,
          itr++) {
         if (not_collaberated_pq.size() < LINK_PREDICTOR_SIZE) {
             not_collaberated_pq.push(*itr);
+            counter.push(not_collaberated_pq.size());
         } else {
             if (((*itr)->priority > not_collaberated_pq.top()->priority) ||
                 ((*itr)->priority == not_collaberated_pq.top()->priority &&
                  (*itr)->name < not_collaberated_pq.top()->name)) {
                 not_collaberated_pq.pop();
                 not_collaberated_pq.push(*itr);
+                counter.pop();
+                counter.push(not_collaberated_pq.size());
             }
         }
     }
@@ -237,12 +397,31 @@ void ActorGraph::predictlink(string targetActorName, ostream& outFile1,
     while (not_collaberated_pq.size() > 0) {
         output2 = not_collaberated_pq.top()->name + "\t" + output2;
         not_collaberated_pq.pop();
+        counter.pop();
     }
     outFile2 << output2 << endl;
 }
 
 /* find the minimal spanning tree of the connected graph */
 void ActorGraph::findMST(ostream& outFile, bool show_abstract_only) {
+    NoCounting counter;
+    findSpanningTree(outFile, show_abstract_only, counter);
+}
+
+/* find the minimal spanning tree of the connected graph and put the effort
+ * of the search in stats */
+void ActorGraph::findMST(ostream& outFile, bool show_abstract_only,
+                         SearchStats& stats) {
+    Counting counter;
+    findSpanningTree(outFile, show_abstract_only, counter);
+    stats = counter.stats;
+}
+
+/* find the minimal spanning tree of the connected graph, counting the effort
+ * of the search with counter */
+template <typename Counter>
+void ActorGraph::findSpanningTree(ostream& outFile, bool show_abstract_only,
+                                  Counter& counter) {
     vector<MovieEdge*> edges;
     // push all movie edges into vector. each movie edge appears only ONCE
     for (auto itr = movies.begin(); itr != movies.end(); itr++) {
@@ -258,7 +437,8 @@ void ActorGraph::findMST(ostream& outFile, bool show_abstract_only) {
     int edgeWeights = 0;
     // create disjoint set
     DisjointSet ds(actors);
-    for (int m = 0; m < edges.size(); m++) {
+    for (size_t m = 0; m < edges.size(); m++) {
+        counter.scan();
         unordered_set<string>& actorsInMovie = edges[m]->actors;
         int weight = edges[m]->weight;
         // pair each two actors who played in this movie
@@ -274,6 +454,7 @@ void ActorGraph::findMST(ostream& outFile, bool show_abstract_only) {
                     string path = "(" + (*itr1) + ")<--[" + edges[m]->key +
                                   "]-->(" + (*itr2) + ")\n";
                     movie_traveling.push_back(path);
+                    counter.settle();
                     // union two disjoint set
                     ds.union_set(sentinel1, sentinel2);
                     // increasing edge weights
@@ -285,7 +466,8 @@ void ActorGraph::findMST(ostream& outFile, bool show_abstract_only) {
                         // write output file
                         if (!show_abstract_only) {
                             outFile << "(actor)<--[movie#@year]-->(actor)\n";
-                            for (int i = 0; i < movie_traveling.size(); i++) {
+                            for (size_t i = 0; i < movie_traveling.size();
+                                 i++) {
                                 outFile << movie_traveling[i];
                             }
                         }
@@ -306,11 +488,220 @@ void ActorGraph::findMST(ostream& outFile, bool show_abstract_only) {
     }
 }
 
+/* build the name-ordered actor index, which gives every actor a dense id */
+void ActorGraph::buildActorIds() {
+    actorIds.clear();
+    for (auto itr = actors.begin(); itr != actors.end(); itr++) {
+        actorIds.push_back(itr->second);
+    }
+    sort(actorIds.begin(), actorIds.end(),
+         [](ActorNode* left, ActorNode* right) {
+             return left->name < right->name;
+         });
+    for (size_t i = 0; i < actorIds.size(); i++) {
+        actorIds[i]->id = i;
+    }
+}
+
+/* find the root of the given actor id in the concurrent union-find */
+static int findRoot(vector<atomic<int>>& parents, int actor) {
+    int parent = parents[actor].load();
+    while (parent != actor) {
+        actor = parent;
+        parent = parents[actor].load();
+    }
+    return actor;
+}
+
+/* link the sets of 2 actor ids, always hanging the larger root below the
+ * smaller one, so the root of every set is its smallest actor id */
+static void linkRoots(vector<atomic<int>>& parents, int actor1, int actor2) {
+    while (true) {
+        int root1 = findRoot(parents, actor1);
+        int root2 = findRoot(parents, actor2);
+        if (root1 == root2) return;
+        if (root1 < root2) swap(root1, root2);
+        // retry if another thread has re-parented root1 in the meantime
+        int expected = root1;
+        if (parents[root1].compare_exchange_strong(expected, root2)) return;
+    }
+}
+
+/* label every actor with the id of its connected component so that queries
+ * between different components can be rejected immediately */
+void ActorGraph::buildComponents(unsigned int numThreads) {
+    buildActorIds();
+    if (numThreads == 0) numThreads = 1;
+
+    vector<MovieEdge*> edges;
+    for (auto itr = movies.begin(); itr != movies.end(); itr++) {
+        edges.push_back(itr->second);
+    }
+
+    // every actor starts in its own set
+    vector<atomic<int>> parents(actorIds.size());
+    for (size_t i = 0; i < parents.size(); i++) {
+        parents[i].store(i);
+    }
+
+    // each thread links the cast of its share of movies to the cast's first
+    // actor. the lock-free links only ever point to smaller ids, so the final
+    // roots do not depend on the thread schedule
+    vector<thread> workers;
+    for (unsigned int t = 0; t < numThreads; t++) {
+        workers.emplace_back([&, t]() {
+            for (size_t m = t; m < edges.size(); m += numThreads) {
+                int first = -1;
+                for (const string& actorName : edges[m]->actors) {
+                    int actor = actors.at(actorName)->id;
+                    if (first == -1) {
+                        first = actor;
+                    } else {
+                        linkRoots(parents, first, actor);
+                    }
+                }
+            }
+        });
+    }
+    for (thread& worker : workers) {
+        worker.join();
+    }
+
+    // roots are the smallest id of each set, so numbering roots in id order
+    // gives the same labels for any number of threads
+    numComponents = 0;
+    for (int i = 0; i < (int)actorIds.size(); i++) {
+        int root = findRoot(parents, i);
+        if (root == i) {
+            actorIds[i]->component = numComponents++;
+        } else {
+            actorIds[i]->component = actorIds[root]->component;
+        }
+    }
+    componentsBuilt = true;
+}
+
+/* print the number and the sizes of the connected components */
+void ActorGraph::printComponentStats(ostream& outFile,
+                                     unsigned int numThreads) {
+    if (!componentsBuilt) buildComponents(numThreads);
+
+    vector<int> sizes(numComponents, 0);
+    for (ActorNode* actor : actorIds) {
+        sizes[actor->component]++;
+    }
+    int largest = 0;
+    int isolated = 0;
+    for (int size : sizes) {
+        largest = max(largest, size);
+        if (size == 1) isolated++;
+    }
+
+    outFile << "#NODE: " << actorIds.size() << endl;
+    outFile << "#COMPONENTS: " << numComponents << endl;
+    outFile << "LARGEST COMPONENT: " << largest << endl;
+    outFile << "ISOLATED ACTORS: " << isolated << endl;
+}
+
+/* choose numLandmarks hub actors as landmarks and precompute their distances
+ */
+void ActorGraph::buildLandmarks(int numLandmarks) {
+    delete landmarks;
+    landmarks = new ActorLandmarks();
+    landmarks->build(*this, numLandmarks);
+}
+
+/* estimate the weighted distance between 2 actors from the landmark distances
+ * only, writing "lower\tupper" bounds (or an empty line if no estimate
+ * exists) */
+void ActorGraph::estimate_distance(string actorName1, string actorName2,
+                                   ostream& outFile) {
+    int actor1 = getActorId(actorName1);
+    int actor2 = getActorId(actorName2);
+    if (actor1 == -1 || actor2 == -1 ||
+        actorIds[actor1]->component != actorIds[actor2]->component) {
+        outFile << endl;
+        return;
+    }
+    if (actor1 == actor2) {
+        outFile << 0 << "\t" << 0 << endl;
+        return;
+    }
+
+    if (!landmarks) buildLandmarks(DEFAULT_LANDMARKS);
+    unsigned int upper = landmarks->upperBound(actor1, actor2);
+    if (upper == ActorLandmarks::UNREACHABLE) {
+        // no landmark in this component
+        outFile << endl;
+        return;
+    }
+    outFile << landmarks->lowerBound(actor1, actor2) << "\t" << upper << endl;
+}
+
+/* build the pruned landmark labeling of the unweighted graph */
+void ActorGraph::buildHopLabels(int numBitParallelRoots) {
+    delete hopLabels;
+    hopLabels = new HopLabels();
+    if (!hopLabels->build(*this, numBitParallelRoots)) {
+        cerr << "Hop distances are too large for the labels!\n";
+        delete hopLabels;
+        hopLabels = 0;
+    }
+}
+
+/* save the hop labels into a binary file, building them first if needed */
+bool ActorGraph::saveHopLabels(const char* filename) {
+    if (!hopLabels) buildHopLabels();
+    return hopLabels && hopLabels->saveToFile(filename);
+}
+
+/* load hop labels saved by saveHopLabels for this graph */
+bool ActorGraph::loadHopLabels(const char* filename) {
+    HopLabels* loaded = new HopLabels();
+    if (!loaded->loadFromFile(filename, *this)) {
+        delete loaded;
+        return false;
+    }
+    delete hopLabels;
+    hopLabels = loaded;
+    return true;
+}
+
+/* return the number of hops between 2 actors, or -1 if there is no path
+ * between them */
+int ActorGraph::hop_distance(string actorName1, string actorName2) {
+    int actor1 = getActorId(actorName1);
+    int actor2 = getActorId(actorName2);
+    if (actor1 == -1 || actor2 == -1) return -1;
+    if (!hopLabels) buildHopLabels();
+    return hopLabels ? hopLabels->query(actor1, actor2) : -1;
+}
+
+/* return the actors ordered by name, indexed by their id */
+const vector<ActorGraph::ActorNode*>& ActorGraph::getActorIndex() {
+    if (!componentsBuilt) buildComponents();
+    return actorIds;
+}
+
+/* return the id of the given actor, or -1 if it does not exist */
+int ActorGraph::getActorId(const string& actorName) {
+    if (!componentsBuilt) buildComponents();
+    auto itr = actors.find(actorName);
+    return itr == actors.end() ? -1 : itr->second->id;
+}
+
 /* helper method to insert (actor, movie) pair into the tree */
 void ActorGraph::insert(string actor, string movie_title, int year,
                         bool use_weighted_edges) {
     string movie_key = movie_title + "#@" + to_string(year);
 
+    // the new pair may merge components and change distances
+    componentsBuilt = false;
+    delete landmarks;
+    landmarks = 0;
+    delete hopLabels;
+    hopLabels = 0;
+
     // create new node and edge if not exists
     if (!actors.count(actor)) {
         // key not exists, create new actor node
@@ -420,7 +811,8 @@ int ActorGraph::ActorNode::getEdgeNum(string actorName) {
 }
 
 /* Constructo that initialize an ActorNode */
-ActorGraph::ActorNode::ActorNode(string name) : name(name), priority(0) {}
+ActorGraph::ActorNode::ActorNode(string name)
+    : name(name), priority(0), id(-1), component(-1) {}
 
 /* a comparator of ActorNode pointer.
  * The node with lower priority value will have higher priority
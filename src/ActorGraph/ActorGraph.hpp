@@ -15,6 +15,10 @@
 #include <unordered_set>
 #include <vector>
 
+#include "ActorLandmarks.hpp"
+#include "HopLabels.hpp"
+#include "SearchStats.hpp"
+
 using namespace std;
 
 /**
@@ -59,6 +63,9 @@ class ActorGraph {
 
         ActorNode* disjointSetParent;  // parent node in the disjoint set
 
+        int id;         // position of the actor in the name-ordered index
+        int component;  // id of the connected component the actor is in
+
         /* Constructo that initialize an ActorNode */
         ActorNode(string name);
 
@@ -86,6 +93,36 @@ class ActorGraph {
     unordered_map<string, ActorNode*> actors;
     unordered_map<string, MovieEdge*> movies;
 
+    vector<ActorNode*> actorIds;  // actors ordered by name, indexed by id
+    bool componentsBuilt;         // whether component ids are up to date
+    int numComponents;            // number of connected components
+
+    ActorLandmarks* landmarks;  // optional, used for weighted queries
+    HopLabels* hopLabels;       // optional, used for unweighted queries
+
+    /* build the name-ordered actor index, which gives every actor a dense id
+     */
+    void buildActorIds();
+
+    /* find the shortest path of the graph, counting the effort of the search
+     * with counter */
+    template <typename Counter>
+    void findActorPath(const string& startActorName, const string& endActorName,
+                       ostream& outFile, bool use_weighted_edges,
+                       Counter& counter);
+
+    /* predict possible future collaberation of other actors and the given
+     * actor, counting the effort of the search with counter */
+    template <typename Counter>
+    void rankLinks(const string& targetActorName, ostream& outFile1,
+                   ostream& outFile2, Counter& counter);
+
+    /* find the minimal spanning tree of the connected graph, counting the
+     * effort of the search with counter */
+    template <typename Counter>
+    void findSpanningTree(ostream& outFile, bool show_abstract_only,
+                          Counter& counter);
+
   public:
     /**
      * Constuctor of the Actor graph
@@ -96,14 +133,75 @@ class ActorGraph {
     void find_path(string startActorName, string endActorName, ostream& outFile,
                    bool use_weighted_edges);
 
+    /* find the shortest path of the graph and put the effort of the search
+     * in stats */
+    void find_path(string startActorName, string endActorName, ostream& outFile,
+                   bool use_weighted_edges, SearchStats& stats);
+
     /* predict possible future collaberation of other actors and the given actor
      */
     void predictlink(string targetActorName, ostream& outFile1,
                      ostream& outFile2);
 
+    /* predict links like predictlink and put the effort of the search in
+     * stats */
+    void predictlink(string targetActorName, ostream& outFile1,
+                     ostream& outFile2, SearchStats& stats);
+
     /* find the minimal spanning tree of the connected graph */
     void findMST(ostream& outFile, bool show_abstract_only);
 
+    /* find the minimal spanning tree and put the effort of the search in
+     * stats */
+    void findMST(ostream& outFile, bool show_abstract_only, SearchStats& stats);
+
+    /* label every actor with the id of its connected component so that
+     * queries between different components can be rejected immediately.
+     * Components are found with a lock-free union-find over the movies,
+     * split among numThreads threads. Labels are numbered in order of the
+     * first actor (by name) of each component, for any number of threads */
+    void buildComponents(unsigned int numThreads = 1);
+
+    /* print the number and the sizes of the connected components */
+    void printComponentStats(ostream& outFile, unsigned int numThreads = 1);
+
+    /* choose numLandmarks hub actors as landmarks and precompute their
+     * distances. Weighted find_path then runs A* with landmark bounds */
+    void buildLandmarks(int numLandmarks);
+
+    /* estimate the weighted distance between 2 actors from the landmark
+     * distances only, writing "lower\tupper" bounds (or an empty line if no
+     * estimate exists). Builds default landmarks if there are none */
+    void estimate_distance(string actorName1, string actorName2,
+                           ostream& outFile);
+
+    /* build the pruned landmark labeling of the unweighted graph, using
+     * numBitParallelRoots bit-parallel BFS. Unweighted find_path then reads
+     * hop distances from the labels instead of running BFS */
+    void buildHopLabels(int numBitParallelRoots = 16);
+
+    /**
+     * Save the hop labels into a binary file, building them first if needed.
+     * return true if file was written sucessfully, false otherwise
+     */
+    bool saveHopLabels(const char* filename);
+
+    /**
+     * Load hop labels saved by saveHopLabels for this graph.
+     * return true if file was loaded sucessfully, false otherwise
+     */
+    bool loadHopLabels(const char* filename);
+
+    /* return the number of hops between 2 actors, or -1 if there is no path
+     * between them. Builds the hop labels if there are none */
+    int hop_distance(string actorName1, string actorName2);
+
+    /* return the actors ordered by name, indexed by their id */
+    const vector<ActorNode*>& getActorIndex();
+
+    /* return the id of the given actor, or -1 if it does not exist */
+    int getActorId(const string& actorName);
+
     /* helper method to insert (actor, movie) pair into the graph */
     void insert(string actor, string movie_title, int year,
                 bool use_weighted_edges);
@@ -0,0 +1,138 @@
+/*
+ * ActorLandmarks.cpp
+ * Author: Yuening YANG, Shenlang ZHOU
+ *
+ * This file shows the implementation details of ActorLandmarks class methods,
+ * which are declared in 'ActorLandmarks.hpp' file.
+ */
+
+#include "ActorLandmarks.hpp"
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+#include "ActorGraph.hpp"
+
+using namespace std;
+
+const unsigned int ActorLandmarks::UNREACHABLE;
+
+/* Constructor of an empty set of landmarks */
+ActorLandmarks::ActorLandmarks(void) : numActors(0) {}
+
+/* choose the numLandmarks actors with the most collaborations as landmarks
+ * and compute their distances to all actors with Dijkstra */
+void ActorLandmarks::build(ActorGraph& graph, int numLandmarks) {
+    const vector<ActorGraph::ActorNode*>& actorIds = graph.getActorIndex();
+    numActors = actorIds.size();
+
+    // flatten the actor-movie relation into id arrays: the movies of actor a
+    // are actorMovies[firstMovie[a], firstMovie[a+1]), the cast of movie m is
+    // castIds[firstCast[m], firstCast[m+1])
+    unordered_map<ActorGraph::MovieEdge*, int> movieIds;
+    vector<int> firstMovie(1, 0);
+    vector<int> actorMovies;
+    vector<int> firstCast(1, 0);
+    vector<int> castIds;
+    vector<unsigned int> movieWeight;
+    vector<long long> collaborations(numActors, 0);
+    for (int actor = 0; actor < numActors; actor++) {
+        for (ActorGraph::MovieEdge* movie : actorIds[actor]->movies) {
+            auto itr = movieIds.find(movie);
+            if (itr == movieIds.end()) {
+                itr = movieIds.emplace(movie, movieIds.size()).first;
+                for (const string& name : movie->actors) {
+                    castIds.push_back(graph.getActorId(name));
+                }
+                firstCast.push_back(castIds.size());
+                movieWeight.push_back(movie->weight);
+            }
+            actorMovies.push_back(itr->second);
+            collaborations[actor] += movie->actors.size() - 1;
+        }
+        firstMovie.push_back(actorMovies.size());
+    }
+
+    // the hubs with the most collaborations are the landmarks
+    vector<int> order(numActors);
+    for (int actor = 0; actor < numActors; actor++) {
+        order[actor] = actor;
+    }
+    numLandmarks = min(numLandmarks, numActors);
+    partial_sort(order.begin(), order.begin() + numLandmarks, order.end(),
+                 [&](int left, int right) {
+                     if (collaborations[left] != collaborations[right]) {
+                         return collaborations[left] > collaborations[right];
+                     }
+                     return left < right;
+                 });
+    landmarks.assign(order.begin(), order.begin() + numLandmarks);
+
+    distances.assign(numLandmarks, vector<unsigned int>());
+    for (int i = 0; i < numLandmarks; i++) {
+        vector<unsigned int>& dist = distances[i];
+        dist.assign(numActors, UNREACHABLE);
+        // actors are settled in order of distance, so the first settled
+        // actor of a movie already gives its cast their best distance
+        // through it and every movie is scanned only once
+        vector<bool> movieScanned(movieWeight.size(), false);
+        vector<bool> settled(numActors, false);
+        priority_queue<pair<unsigned int, int>,
+                       vector<pair<unsigned int, int>>,
+                       greater<pair<unsigned int, int>>>
+            toExplore;
+        dist[landmarks[i]] = 0;
+        toExplore.emplace(0, landmarks[i]);
+        while (!toExplore.empty()) {
+            int current = toExplore.top().second;
+            toExplore.pop();
+            if (settled[current]) continue;
+            settled[current] = true;
+            for (int m = firstMovie[current]; m < firstMovie[current + 1];
+                 m++) {
+                int movie = actorMovies[m];
+                if (movieScanned[movie]) continue;
+                movieScanned[movie] = true;
+                unsigned int newDist = dist[current] + movieWeight[movie];
+                for (int c = firstCast[movie]; c < firstCast[movie + 1]; c++) {
+                    int next = castIds[c];
+                    if (newDist < dist[next]) {
+                        dist[next] = newDist;
+                        toExplore.emplace(newDist, next);
+                    }
+                }
+            }
+        }
+    }
+}
+
+/* return a lower bound of the distance between actor1 and actor2 */
+unsigned int ActorLandmarks::lowerBound(int actor1, int actor2) const {
+    unsigned int bound = 0;
+    for (const vector<unsigned int>& dist : distances) {
+        // landmarks in another component give no bound
+        if (dist[actor1] == UNREACHABLE || dist[actor2] == UNREACHABLE) {
+            continue;
+        }
+        unsigned int diff = dist[actor1] > dist[actor2]
+                                ? dist[actor1] - dist[actor2]
+                                : dist[actor2] - dist[actor1];
+        bound = max(bound, diff);
+    }
+    return bound;
+}
+
+/* return an upper bound of the distance between actor1 and actor2, or
+ * UNREACHABLE if no landmark is connected to both */
+unsigned int ActorLandmarks::upperBound(int actor1, int actor2) const {
+    unsigned int bound = UNREACHABLE;
+    for (const vector<unsigned int>& dist : distances) {
+        if (dist[actor1] == UNREACHABLE || dist[actor2] == UNREACHABLE) {
+            continue;
+        }
+        bound = min(bound, dist[actor1] + dist[actor2]);
+    }
+    return bound;
+}
@@ -0,0 +1,54 @@
+/**
+ * ActorLandmarks.hpp
+ * Author: Yuening YANG, Shenlang ZHOU
+ *
+ * This file declares the structure of ActorLandmarks class, which precomputes
+ * the distances from hub actors to bound and estimate weighted distances.
+ */
+#ifndef ACTORLANDMARKS_HPP
+#define ACTORLANDMARKS_HPP
+
+#include <vector>
+
+using namespace std;
+
+class ActorGraph;
+
+/**
+ * This class defines a set of landmark actors (the actors with the most
+ * collaborations) together with the shortest weighted distance from every
+ * landmark to every actor. For every landmark L and actors a and b,
+ * |dist(L, a) - dist(L, b)| <= dist(a, b) <= dist(a, L) + dist(L, b), which
+ * gives an A* lower bound and a quick distance estimate.
+ */
+class ActorLandmarks {
+  public:
+    static const unsigned int UNREACHABLE = 0xffffffff;
+
+  private:
+    int numActors;
+    vector<int> landmarks;  // ids of the landmark actors
+
+    /* distances[i][a] is the dist from landmark i to actor a */
+    vector<vector<unsigned int>> distances;
+
+  public:
+    /* Constructor of an empty set of landmarks */
+    ActorLandmarks(void);
+
+    /* choose the numLandmarks actors with the most collaborations as
+     * landmarks and compute their distances to all actors with Dijkstra */
+    void build(ActorGraph& graph, int numLandmarks);
+
+    /* return a lower bound of the distance between actor1 and actor2 */
+    unsigned int lowerBound(int actor1, int actor2) const;
+
+    /* return an upper bound of the distance between actor1 and actor2, or
+     * UNREACHABLE if no landmark is connected to both */
+    unsigned int upperBound(int actor1, int actor2) const;
+
+    /* return the ids of the landmark actors */
+    const vector<int>& getLandmarks() const { return landmarks; }
+};
+
+#endif  // ACTORLANDMARKS_HPP
@@ -0,0 +1,366 @@
+/*
+ * HopLabels.cpp
+ * Author: Yuening YANG, Shenlang ZHOU
+ *
+ * This file shows the implementation details of HopLabels class methods,
+ * which are declared in 'HopLabels.hpp' file.
+ */
+
+#include "HopLabels.hpp"
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "ActorGraph.hpp"
+
+using namespace std;
+
+const unsigned char HopLabels::INF;
+const int MAX_BIT_PARALLEL_ROOTS = 64;    // roots of the bit-parallel BFS
+const int MAX_NEIGHBORS_PER_ROOT = 64;    // bits of a neighbor set
+const char LABEL_FILE_MAGIC[8] = "HOPLBL1";  // header of label files
+
+/* add the characters of text and a separator to an FNV-1a hash */
+static void hashText(unsigned long long& hash, const string& text, char end) {
+    for (char ch : text) {
+        hash = (hash ^ (unsigned char)ch) * 1099511628211ULL;
+    }
+    hash = (hash ^ (unsigned char)end) * 1099511628211ULL;
+}
+
+/* hash the names of the actors in id order, each with the sorted keys of its
+ * movies, so labels are only loaded for the graph they were built from */
+static unsigned long long hashGraph(ActorGraph& graph) {
+    unsigned long long hash = 14695981039346656037ULL;  // FNV-1a
+    vector<string> keys;
+    for (ActorGraph::ActorNode* actor : graph.getActorIndex()) {
+        hashText(hash, actor->name, '\t');
+        keys.clear();
+        for (ActorGraph::MovieEdge* movie : actor->movies) {
+            keys.push_back(movie->key);
+        }
+        sort(keys.begin(), keys.end());
+        for (const string& key : keys) {
+            hashText(hash, key, '\n');
+        }
+    }
+    return hash;
+}
+
+/* Constructor of an empty labeling */
+HopLabels::HopLabels(void)
+    : numActors(0), numRoots(0), firstLabel(1, 0), graphHash(0) {}
+
+/* build the labels of all actors of the graph */
+bool HopLabels::build(ActorGraph& graph, int numRoots) {
+    const vector<ActorGraph::ActorNode*>& actorIds = graph.getActorIndex();
+    numActors = actorIds.size();
+    graphHash = hashGraph(graph);
+
+    // actors that shared a movie are neighbors
+    vector<vector<int>> neighbors(numActors);
+    for (int actor = 0; actor < numActors; actor++) {
+        for (ActorGraph::MovieEdge* movie : actorIds[actor]->movies) {
+            for (const string& name : movie->actors) {
+                int next = graph.getActorId(name);
+                if (next != actor) neighbors[actor].push_back(next);
+            }
+        }
+        sort(neighbors[actor].begin(), neighbors[actor].end());
+        neighbors[actor].erase(
+            unique(neighbors[actor].begin(), neighbors[actor].end()),
+            neighbors[actor].end());
+    }
+
+    // hubs are ranked by decreasing degree
+    vector<int> order(numActors);
+    for (int actor = 0; actor < numActors; actor++) {
+        order[actor] = actor;
+    }
+    sort(order.begin(), order.end(), [&](int left, int right) {
+        if (neighbors[left].size() != neighbors[right].size()) {
+            return neighbors[left].size() > neighbors[right].size();
+        }
+        return left < right;
+    });
+    vector<int> rank(numActors);
+    for (int i = 0; i < numActors; i++) {
+        rank[order[i]] = i;
+    }
+    for (int actor = 0; actor < numActors; actor++) {
+        sort(neighbors[actor].begin(), neighbors[actor].end(),
+             [&](int left, int right) { return rank[left] < rank[right]; });
+    }
+
+    // bit-parallel BFS from the top hubs, each also covering up to 64 of its
+    // neighbors. Covered actors need no normal BFS of their own
+    vector<bool> covered(numActors, false);
+    numRoots = min(numRoots, MAX_BIT_PARALLEL_ROOTS);
+    vector<int> roots;
+    vector<vector<int>> chosenNeighbors;
+    for (int i = 0; i < numActors && (int)roots.size() < numRoots; i++) {
+        int root = order[i];
+        if (covered[root]) continue;
+        covered[root] = true;
+        roots.push_back(root);
+        chosenNeighbors.emplace_back();
+        for (int next : neighbors[root]) {
+            if (chosenNeighbors.back().size() == MAX_NEIGHBORS_PER_ROOT) break;
+            if (!covered[next]) {
+                covered[next] = true;
+                chosenNeighbors.back().push_back(next);
+            }
+        }
+    }
+    this->numRoots = roots.size();
+    bpDist.assign((size_t)numActors * roots.size(), INF);
+    bpCloser.assign((size_t)numActors * roots.size(), 0);
+    bpSame.assign((size_t)numActors * roots.size(), 0);
+
+    vector<int> queue(numActors);
+    for (size_t i = 0; i < roots.size(); i++) {
+        int root = roots[i];
+        vector<unsigned char> dist(numActors, INF);
+        vector<unsigned long long> closer(numActors, 0);
+        vector<unsigned long long> same(numActors, 0);
+        int head = 0;
+        queue[head++] = root;
+        dist[root] = 0;
+        int levelStart = 0;
+        int levelEnd = head;
+
+        // the chosen neighbors are the next level, each with its own bit
+        for (size_t bit = 0; bit < chosenNeighbors[i].size(); bit++) {
+            int next = chosenNeighbors[i][bit];
+            queue[head++] = next;
+            dist[next] = 1;
+            closer[next] = 1ULL << bit;
+        }
+
+        for (int d = 0; levelStart < head; d++) {
+            vector<pair<int, int>> siblingEdges;
+            vector<pair<int, int>> childEdges;
+            for (int q = levelStart; q < levelEnd; q++) {
+                int current = queue[q];
+                for (int next : neighbors[current]) {
+                    if (dist[next] < d) continue;
+                    if (dist[next] == d) {
+                        if (current < next) {
+                            siblingEdges.emplace_back(current, next);
+                        }
+                    } else {
+                        if (dist[next] == INF) {
+                            if (d + 1 >= INF) return false;
+                            queue[head++] = next;
+                            dist[next] = d + 1;
+                        }
+                        childEdges.emplace_back(current, next);
+                    }
+                }
+            }
+            // a neighbor at the same depth is one hop away, and a child
+            // inherits the sets of its parents
+            for (const pair<int, int>& edge : siblingEdges) {
+                same[edge.first] |= closer[edge.second];
+                same[edge.second] |= closer[edge.first];
+            }
+            for (const pair<int, int>& edge : childEdges) {
+                closer[edge.second] |= closer[edge.first];
+                same[edge.second] |= same[edge.first];
+            }
+            levelStart = levelEnd;
+            levelEnd = head;
+        }
+
+        for (int actor = 0; actor < numActors; actor++) {
+            size_t index = (size_t)actor * roots.size() + i;
+            bpDist[index] = dist[actor];
+            bpCloser[index] = closer[actor];
+            bpSame[index] = same[actor] & ~closer[actor];
+        }
+    }
+
+    // pruned BFS from every other actor in rank order
+    vector<vector<pair<unsigned int, unsigned char>>> labels(numActors);
+    vector<unsigned char> rootDist(numActors, INF);  // indexed by hub rank
+    vector<unsigned char> visitDist(numActors, INF);
+    for (int r = 0; r < numActors; r++) {
+        int root = order[r];
+        if (covered[root]) continue;
+        for (const auto& entry : labels[root]) {
+            rootDist[entry.first] = entry.second;
+        }
+
+        int head = 0;
+        queue[head++] = root;
+        visitDist[root] = 0;
+        for (int q = 0; q < head; q++) {
+            int current = queue[q];
+            unsigned char d = visitDist[current];
+
+            // prune if the labels so far already give a path this short
+            if (bitParallelQuery(root, current) <= d) continue;
+            bool pruned = false;
+            for (const auto& entry : labels[current]) {
+                if (rootDist[entry.first] != INF &&
+                    rootDist[entry.first] + entry.second <= d) {
+                    pruned = true;
+                    break;
+                }
+            }
+            if (pruned) continue;
+
+            labels[current].emplace_back(r, d);
+            for (int next : neighbors[current]) {
+                if (visitDist[next] == INF) {
+                    if (d + 1 >= INF) return false;
+                    visitDist[next] = d + 1;
+                    queue[head++] = next;
+                }
+            }
+        }
+
+        for (int q = 0; q < head; q++) {
+            visitDist[queue[q]] = INF;
+        }
+        for (const auto& entry : labels[root]) {
+            rootDist[entry.first] = INF;
+        }
+    }
+
+    // lay out the labels of each actor contiguously
+    firstLabel.assign(1, 0);
+    labelHub.clear();
+    labelDist.clear();
+    for (int actor = 0; actor < numActors; actor++) {
+        for (const auto& entry : labels[actor]) {
+            labelHub.push_back(entry.first);
+            labelDist.push_back(entry.second);
+        }
+        firstLabel.push_back(labelHub.size());
+    }
+    return true;
+}
+
+/* return the distance given by the bit-parallel labels only */
+int HopLabels::bitParallelQuery(int actor1, int actor2) const {
+    int best = INF;
+    size_t index1 = (size_t)actor1 * numRoots;
+    size_t index2 = (size_t)actor2 * numRoots;
+    for (int i = 0; i < numRoots; i++) {
+        if (bpDist[index1 + i] == INF || bpDist[index2 + i] == INF) continue;
+        int dist = bpDist[index1 + i] + bpDist[index2 + i];
+        if (dist - 2 > best) continue;
+        // a chosen neighbor one hop closer to both saves 2 hops, one that is
+        // closer to one and as close to the other saves 1
+        if (bpCloser[index1 + i] & bpCloser[index2 + i]) {
+            dist -= 2;
+        } else if ((bpCloser[index1 + i] & bpSame[index2 + i]) |
+                   (bpSame[index1 + i] & bpCloser[index2 + i])) {
+            dist -= 1;
+        }
+        best = min(best, dist);
+    }
+    return best;
+}
+
+/* return the hop distance between 2 actor ids, or -1 if there is no path */
+int HopLabels::query(int actor1, int actor2) const {
+    if (actor1 == actor2) return 0;
+    int best = bitParallelQuery(actor1, actor2);
+
+    // merge the 2 sorted label lists
+    unsigned long long i = firstLabel[actor1];
+    unsigned long long j = firstLabel[actor2];
+    unsigned long long end1 = firstLabel[actor1 + 1];
+    unsigned long long end2 = firstLabel[actor2 + 1];
+    while (i < end1 && j < end2) {
+        if (labelHub[i] == labelHub[j]) {
+            best = min(best, labelDist[i] + labelDist[j]);
+            i++;
+            j++;
+        } else if (labelHub[i] < labelHub[j]) {
+            i++;
+        } else {
+            j++;
+        }
+    }
+    return best >= INF ? -1 : best;
+}
+
+/* write an array with its size into a binary stream */
+template <typename T>
+static void writeArray(ofstream& out, const vector<T>& array) {
+    unsigned long long size = array.size();
+    out.write((const char*)&size, sizeof(size));
+    out.write((const char*)array.data(), size * sizeof(T));
+}
+
+/* read an array written by writeArray from a binary stream of fileSize bytes,
+ * return false before allocating it if its size is not the expected one or
+ * longer than the rest of the stream */
+template <typename T>
+static bool readArray(ifstream& in, vector<T>& array,
+                      unsigned long long expected,
+                      unsigned long long fileSize) {
+    unsigned long long size = 0;
+    if (!in.read((char*)&size, sizeof(size)) || size != expected) {
+        return false;
+    }
+    unsigned long long left = fileSize - (unsigned long long)in.tellg();
+    if (size > left / sizeof(T)) return false;
+    array.resize(size);
+    return (bool)in.read((char*)array.data(), size * sizeof(T));
+}
+
+/* save the labels into a binary file */
+bool HopLabels::saveToFile(const char* filename) const {
+    ofstream out(filename, ios::binary);
+    out.write(LABEL_FILE_MAGIC, sizeof(LABEL_FILE_MAGIC));
+    out.write((const char*)&graphHash, sizeof(graphHash));
+    out.write((const char*)&numActors, sizeof(numActors));
+    out.write((const char*)&numRoots, sizeof(numRoots));
+    writeArray(out, bpDist);
+    writeArray(out, bpCloser);
+    writeArray(out, bpSame);
+    writeArray(out, firstLabel);
+    writeArray(out, labelHub);
+    writeArray(out, labelDist);
+    return (bool)out;
+}
+
+/* load labels saved by saveToFile for the given graph */
+bool HopLabels::loadFromFile(const char* filename, ActorGraph& graph) {
+    ifstream in(filename, ios::binary | ios::ate);
+    if (!in) return false;
+    unsigned long long fileSize = in.tellg();
+    in.seekg(0);
+    char magic[sizeof(LABEL_FILE_MAGIC)];
+    if (!in.read(magic, sizeof(magic)) ||
+        !equal(magic, magic + sizeof(magic), LABEL_FILE_MAGIC)) {
+        return false;
+    }
+    // the labels must belong to this graph
+    if (!in.read((char*)&graphHash, sizeof(graphHash)) ||
+        !in.read((char*)&numActors, sizeof(numActors)) ||
+        !in.read((char*)&numRoots, sizeof(numRoots)) ||
+        graphHash != hashGraph(graph) ||
+        numActors != (int)graph.getActorIndex().size() || numRoots < 0) {
+        return false;
+    }
+    // and be consistent, which is checked before reading each array
+    unsigned long long bpSize = (unsigned long long)numActors * numRoots;
+    if (!readArray(in, bpDist, bpSize, fileSize) ||
+        !readArray(in, bpCloser, bpSize, fileSize) ||
+        !readArray(in, bpSame, bpSize, fileSize) ||
+        !readArray(in, firstLabel, numActors + 1ULL, fileSize) ||
+        firstLabel[0] != 0) {
+        return false;
+    }
+    for (int actor = 0; actor < numActors; actor++) {
+        if (firstLabel[actor + 1] < firstLabel[actor]) return false;
+    }
+    return readArray(in, labelHub, firstLabel.back(), fileSize) &&
+           readArray(in, labelDist, firstLabel.back(), fileSize);
+}
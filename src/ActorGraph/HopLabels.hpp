@@ -0,0 +1,87 @@
+/**
+ * HopLabels.hpp
+ * Author: Yuening YANG, Shenlang ZHOU
+ *
+ * This file declares the structure of HopLabels class, a pruned landmark
+ * labeling of the actor graph that answers exact hop distances.
+ */
+#ifndef HOPLABELS_HPP
+#define HOPLABELS_HPP
+
+#include <vector>
+
+using namespace std;
+
+class ActorGraph;
+
+/**
+ * This class defines a 2-hop labeling of the unweighted actor graph. Every
+ * actor keeps a short list of (hub, dist) pairs such that any 2 actors share
+ * a hub on one of their shortest paths, so their hop distance is the minimum
+ * of dist1 + dist2 over the common hubs of 2 sorted lists. Labels are built
+ * with a BFS from every actor in decreasing order of degree, pruned wherever
+ * the labels found so far already give the distance. The top hubs are
+ * handled by bit-parallel BFS instead, each covering a root and up to 64 of
+ * its neighbors at once.
+ */
+class HopLabels {
+  public:
+    static const unsigned char INF = 0xff;  // dist of unreachable pairs
+
+  private:
+    int numActors;
+    int numRoots;  // number of bit-parallel roots
+
+    /* bit-parallel labels of actor a for root i, at a * numRoots + i: the
+     * dist to the root, and the sets of the root's chosen neighbors that are
+     * one hop closer (bpCloser) or as close (bpSame) to a as the root */
+    vector<unsigned char> bpDist;
+    vector<unsigned long long> bpCloser;
+    vector<unsigned long long> bpSame;
+
+    /* normal labels of actor a are [firstLabel[a], firstLabel[a+1]), sorted
+     * by hub rank (position in the degree order) */
+    vector<unsigned long long> firstLabel;
+    vector<unsigned int> labelHub;
+    vector<unsigned char> labelDist;
+
+    unsigned long long graphHash;  // hash of the actors and their movies
+
+    /* return the distance given by the bit-parallel labels only */
+    int bitParallelQuery(int actor1, int actor2) const;
+
+  public:
+    /* Constructor of an empty labeling */
+    HopLabels(void);
+
+    /**
+     * Build the labels of all actors of the graph, using numRoots (at most
+     * 64) bit-parallel BFS for the actors of highest degree.
+     *
+     * return false if some distance is too large to be stored
+     */
+    bool build(ActorGraph& graph, int numRoots);
+
+    /* return the hop distance between 2 actor ids, or -1 if there is no
+     * path between them */
+    int query(int actor1, int actor2) const;
+
+    /* return the total number of normal label entries */
+    unsigned long long getNumLabels() const { return labelHub.size(); }
+
+    /**
+     * Save the labels into a binary file.
+     *
+     * return true if file was written sucessfully, false otherwise
+     */
+    bool saveToFile(const char* filename) const;
+
+    /**
+     * Load labels saved by saveToFile for the given graph.
+     *
+     * return true if file was loaded sucessfully, false otherwise
+     */
+    bool loadFromFile(const char* filename, ActorGraph& graph);
+};
+
+#endif  // HOPLABELS_HPP
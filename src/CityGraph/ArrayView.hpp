@@ -0,0 +1,65 @@
+/**
+ * ArrayView.hpp
+ * Author: Yuening YANG, Shenlang ZHOU
+ *
+ * This file declares the ArrayView class template, a read-only array whose
+ * elements are either owned or stored elsewhere, such as in a mapped file.
+ */
+#ifndef ARRAYVIEW_HPP
+#define ARRAYVIEW_HPP
+
+#include <stddef.h>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+/**
+ * This class defines a read-only array. It either owns its elements, handed
+ * over as a vector once they are computed, or refers to elements owned by
+ * someone else, so that the arrays of a snapshot file are used in place once
+ * the file is mapped into memory.
+ */
+template <typename T>
+class ArrayView {
+  private:
+    vector<T> owned;  // the elements, unless they are stored elsewhere
+    const T* items;   // first element
+    size_t count;     // number of elements
+
+  public:
+    /* Constructor of an empty array */
+    ArrayView(void) : items(0), count(0) {}
+
+    /* the elements may belong to this array, so it is never copied */
+    ArrayView(const ArrayView&) = delete;
+    ArrayView& operator=(const ArrayView&) = delete;
+
+    /* take over the elements of values, which is left empty */
+    void own(vector<T>&& values) {
+        owned = move(values);
+        items = owned.data();
+        count = owned.size();
+    }
+
+    /* refer to count elements stored elsewhere, which must outlive this
+     * array or the next call to own or refer */
+    void refer(const T* items, size_t count) {
+        vector<T>().swap(owned);
+        this->items = items;
+        this->count = count;
+    }
+
+    /* remove all the elements */
+    void clear() { refer(0, 0); }
+
+    const T& operator[](size_t i) const { return items[i]; }
+    const T* data() const { return items; }
+    const T* begin() const { return items; }
+    const T* end() const { return items + count; }
+    const T& back() const { return items[count - 1]; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+};
+
+#endif  // ARRAYVIEW_HPP
@@ -8,31 +8,96 @@
  */
 
 #include "CityGraph.hpp"
+#include <fcntl.h>
 #include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <queue>
 #include <sstream>
+#include <unordered_set>
 #include <vector>
 
 using namespace std;
 
 const int c = 1;  // coefficient related to heuristic function
+const char SNAPSHOT_MAGIC[8] = "CITYSNP";  // header of snapshot files
+const uint32_t SNAPSHOT_VERSION = 3;       // layout of snapshot files
+const uint32_t SNAPSHOT_LANDMARKS = 1;     // the snapshot has landmarks
+const uint32_t SNAPSHOT_HIERARCHY = 2;     // the snapshot has a hierarchy
+const double MAX_STRETCH = 1.25;  // alternatives are at most 25% longer
+const double MAX_OVERLAP = 0.8;   // and share at most 80% of the best length
+const double MIN_PLATEAU = 0.25;  // and are optimal over a quarter of it
+const int TOUR_RESTARTS = 16;     // starts tried by findTour
+
+/* fixed-size header at the start of a snapshot file */
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;  // which optional sections follow the graph
+    uint64_t sourceStamp;  // sizes and times of the files read for the graph
+    uint64_t numCities;
+    uint64_t numNameChars;
+    uint64_t numRoads;
+    uint64_t numLandmarks;
+    uint32_t numRequestedLandmarks;  // how the landmarks were built
+    uint32_t landmarkStrategy;
+    uint64_t numArcs;  // arcs of the hierarchy
+    double heuristicScale;
+};
 
 /* Constructor of CityGraph */
-CityGraph::CityGraph(void) {}
+CityGraph::CityGraph(void)
+    : indexBuilt(false),
+      heuristicScale(c),
+      snapshot(0),
+      snapshotSize(0),
+      spatialIndexBuilt(false),
+      engine(ASTAR),
+      hierarchy(0),
+      customizable(0),
+      hubLabels(0),
+      landmarks(0),
+      reaches(0) {}
 
 /* Destructor of the City Graph */
 CityGraph::~CityGraph() {
     for (auto itr = cities.begin(); itr != cities.end(); itr++) {
         delete itr->second;
     }
+    deletePreprocessing();
+    releaseSnapshot();
 }
 
-/* find the shortest path from start city to target city using A* Algorithm
- */
+/* find the shortest path from start city to target city using the selected
+ * engine (A* Algorithm by default) */
 void CityGraph::find_path(string startCityName, string endCityName,
                           ostream& out) {
+    NoCounting counter;
+    findNamedPath(startCityName, endCityName, out, counter);
+}
+
+/* find the shortest path like find_path and put the effort of the search in
+ * stats */
+void CityGraph::find_path(string startCityName, string endCityName,
+                          ostream& out, SearchStats& stats) {
+    Counting counter;
+    findNamedPath(startCityName, endCityName, out, counter);
+    stats = counter.stats;
+}
+
+/* find the shortest path between 2 city names for find_path, counting the
+ * effort of the search with counter */
+template <typename Counter>
+void CityGraph::findNamedPath(const string& startCityName,
+                              const string& endCityName, ostream& out,
+                              Counter& counter) {
     // if the start and end are the same city, then output an empty line
     if (startCityName == endCityName) {
         out << endl;
@@ -40,64 +105,1038 @@ void CityGraph::find_path(string startCityName, string endCityName,
     }
 
     // if city not exists, the output an empty line
-    if (cities.count(startCityName) == 0 || cities.count(endCityName) == 0) {
+    int start = getCityId(startCityName);
+    int end = getCityId(endCityName);
+    if (start == -1 || end == -1) {
         out << endl;
         return;
     }
-    // get start and end nodes
-    CityNode* start = cities.at(startCityName);
-    CityNode* end = cities.at(endCityName);
 
-    // reset graph
-    for (auto itr = cities.begin(); itr != cities.end(); itr++) {
-        itr->second->dist = INT32_MAX;
-        itr->second->heuristic = sqrt(pow(itr->second->x - end->x, 2) +
-                                      pow(itr->second->y - end->y, 2));
-        itr->second->prev = 0;
+    prepareEngine();
+    vector<int> path;
+    searchPath(start, end, path, forward, backward, counter);
+    printPath(path, out);
+}
+
+/* build the index and whatever the selected engine needs */
+void CityGraph::prepareEngine() {
+    if (!indexBuilt) buildIndex();
+    if (engine == CONTRACTION_HIERARCHY && !hierarchy) buildHierarchy();
+    if (engine == HUB_LABELS && !hubLabels) buildHubLabels();
+    if (engine == CUSTOMIZABLE_HIERARCHY && !customizable) {
+        buildCustomizableHierarchy();
     }
-    start->dist = 0;
+    if (engine == ALT && !landmarks) buildLandmarks();
+    if (engine == REACH && !reaches) buildReaches();
+}
+
+/* find the shortest path between 2 city ids with the selected engine */
+void CityGraph::findPath(int start, int end, vector<int>& path,
+                         SearchSpace& forward, SearchSpace& backward) const {
+    NoCounting counter;
+    searchPath(start, end, path, forward, backward, counter);
+}
 
-    // perform A-Start Algorithm to find the shortest path
-    priority_queue<CityNode*, vector<CityNode*>, CityNode::FValueComp>
+/* find the shortest path like findPath and put the effort of the search in
+ * stats */
+void CityGraph::findPath(int start, int end, vector<int>& path,
+                         SearchSpace& forward, SearchSpace& backward,
+                         SearchStats& stats) const {
+    Counting counter;
+    searchPath(start, end, path, forward, backward, counter);
+    stats = counter.stats;
+}
+
+/* find the shortest path between 2 city ids with the selected engine,
+ * counting the effort of the search with counter */
+template <typename Counter>
+void CityGraph::searchPath(int start, int end, vector<int>& path,
+                           SearchSpace& forward, SearchSpace& backward,
+                           Counter& counter) const {
+    path.clear();
+    // if in different components, there is no path between them
+    if (start == end || components[start] != components[end]) return;
+
+    if (engine == CONTRACTION_HIERARCHY) {
+        hierarchy->query(start, end, path, forward, backward, counter);
+    } else if (engine == HUB_LABELS) {
+        hubLabels->query(start, end, &path);
+    } else if (engine == CUSTOMIZABLE_HIERARCHY) {
+        customizable->query(start, end, path, forward, backward);
+    } else if (engine == BIDIRECTIONAL_ASTAR) {
+        findBidirectionalPath(start, end, path, forward, backward, counter);
+    } else {
+        findAStarPath(start, end, path, forward, counter);
+    }
+}
+
+/* find the shortest path between 2 city ids like findPath, with the shortest
+ * path tree of start in cache */
+void CityGraph::findTreePath(int start, int end, vector<int>& path,
+                             PathTreeCache& cache) const {
+    path.clear();
+    if (start == end || components[start] != components[end]) return;
+    cache.findPath(*this, start, end, path);
+}
+
+/* find the shortest path from start to end with A* and put its cities in path
+ * (empty if there is no path) */
+template <typename Counter>
+void CityGraph::findAStarPath(int start, int end, vector<int>& path,
+                              SearchSpace& space, Counter& counter) const {
+    path.clear();
+
+    // reset graph, cities are initialized lazily when first reached
+    space.newQuery(getNumCities());
+    space.touch(start);
+    space.heuristic[start] = estimate(start, end);
+    space.dist[start] = 0;
+
+    // perform A-Start Algorithm to find the shortest path. Nodes with lower
+    // (f = dist + heuristic) value have higher priority, ties are broken by
+    // the lower id, i.e. the name in lower alphabetic order
+    priority_queue<pair<double, int>, vector<pair<double, int>>,
+                   greater<pair<double, int>>>
         toExplore;
-    toExplore.push(start);
+    toExplore.emplace(space.heuristic[start], start);
+    counter.push(toExplore.size());
 
     while (!toExplore.empty()) {
-        CityNode* current = toExplore.top();
+        int current = toExplore.top().second;
+        toExplore.pop();
+        counter.pop();
+        // skip outdated entries of cities that are already settled
+        if (space.isSettled(current)) {
+            counter.stalePop();
+            continue;
+        }
+        space.settle(current);
+        counter.settle();
         // if get target city, break
         if (current == end) break;
-        toExplore.pop();
-        for (string nextCityName : current->neighbors) {
-            CityNode* next = cities.at(nextCityName);
-            double distance = sqrt(pow(next->x - current->x, 2) +
-                                   pow(next->y - current->y, 2));
-            if (distance + current->dist < next->dist) {
-                next->dist = current->dist + distance;
-                next->prev = current;
+        for (int road = firstRoad[current]; road < firstRoad[current + 1];
+             road++) {
+            counter.scan();
+            int next = roadTarget[road];
+            if (space.isSettled(next)) continue;
+            // the heuristic is only evaluated for the cities reached
+            if (space.touch(next)) space.heuristic[next] = estimate(next, end);
+            double distance = space.dist[current] + roadLength[road];
+            // the reach engine skips cities too far from both ends for the
+            // shortest path to go through them
+            if (engine == REACH &&
+                reaches->prune(next, distance, space.heuristic[next])) {
+                continue;
+            }
+            if (distance < space.dist[next]) {
+                space.dist[next] = distance;
+                space.prev[next] = current;
                 // push it to the priority queue
-                toExplore.push(next);
+                toExplore.emplace(distance + space.heuristic[next], next);
+                counter.push(toExplore.size());
             }
         }
     }
 
-    // if no path (not connected), then output an empty line
-    if (end->prev == 0) {
-        out << endl;
+    // if no path (not connected), then leave the path empty
+    if (!space.isSettled(end)) return;
+
+    for (int city = end; city != start; city = space.prev[city]) {
+        path.push_back(city);
+    }
+    path.push_back(start);
+    reverse(path.begin(), path.end());
+}
+
+/* find the shortest path from start to end with bidirectional A* and put its
+ * cities in path (empty if there is no path) */
+template <typename Counter>
+void CityGraph::findBidirectionalPath(int start, int end, vector<int>& path,
+                                      SearchSpace& forward,
+                                      SearchSpace& backward,
+                                      Counter& counter) const {
+    path.clear();
+
+    // the forward search uses the potential (h(v, end) - h(v, start)) / 2 and
+    // the backward search its opposite. They sum to 0, so both searches see
+    // the same consistent reduced road lengths
+    SearchSpace* spaces[2] = {&forward, &backward};
+    int origins[2] = {start, end};
+    auto potential = [&](int city) {
+        return (estimate(city, end) - estimate(city, start)) / 2;
+    };
+
+    priority_queue<pair<double, int>, vector<pair<double, int>>,
+                   greater<pair<double, int>>>
+        toExplore[2];
+    for (int dir = 0; dir < 2; dir++) {
+        SearchSpace& space = *spaces[dir];
+        space.newQuery(getNumCities());
+        space.touch(origins[dir]);
+        space.heuristic[origins[dir]] =
+            dir == 0 ? potential(origins[dir]) : -potential(origins[dir]);
+        space.dist[origins[dir]] = 0;
+        toExplore[dir].emplace(space.heuristic[origins[dir]], origins[dir]);
+        counter.push(toExplore[dir].size());
+    }
+
+    double best = INT32_MAX;  // length of the best path found so far
+    int meeting = -1;         // city where the best path meets
+    while (!toExplore[0].empty() && !toExplore[1].empty()) {
+        // with these potentials, no shorter path can be found once the
+        // smallest keys of both directions sum to the best length
+        if (toExplore[0].top().first + toExplore[1].top().first >= best) {
+            break;
+        }
+
+        // expand the direction with the smaller key
+        int dir = toExplore[0].top().first <= toExplore[1].top().first ? 0 : 1;
+        SearchSpace& space = *spaces[dir];
+        SearchSpace& other = *spaces[1 - dir];
+        int current = toExplore[dir].top().second;
+        toExplore[dir].pop();
+        counter.pop();
+        if (space.isSettled(current)) {
+            counter.stalePop();
+            continue;
+        }
+        space.settle(current);
+        counter.settle();
+
+        for (int road = firstRoad[current]; road < firstRoad[current + 1];
+             road++) {
+            counter.scan();
+            int next = roadTarget[road];
+            if (space.isSettled(next)) continue;
+            if (space.touch(next)) {
+                space.heuristic[next] =
+                    dir == 0 ? potential(next) : -potential(next);
+            }
+            double distance = space.dist[current] + roadLength[road];
+            if (distance < space.dist[next]) {
+                space.dist[next] = distance;
+                space.prev[next] = current;
+                toExplore[dir].emplace(distance + space.heuristic[next], next);
+                counter.push(toExplore[dir].size());
+                // check whether the other search already reached this city
+                if (other.isReached(next) &&
+                    distance + other.dist[next] < best) {
+                    best = distance + other.dist[next];
+                    meeting = next;
+                }
+            }
+        }
+    }
+
+    if (meeting == -1) return;
+
+    // cities from start to the meeting city, then on to end
+    for (int city = meeting; city != -1; city = forward.prev[city]) {
+        path.push_back(city);
+    }
+    reverse(path.begin(), path.end());
+    for (int city = backward.prev[meeting]; city != -1;
+         city = backward.prev[city]) {
+        path.push_back(city);
+    }
+}
+
+/* grow a shortest path tree from origin with A* toward target, going on after
+ * target until the keys exceed stretch times its distance */
+double CityGraph::growTree(int origin, int target, double stretch,
+                           SearchSpace& space, vector<int>& settled) const {
+    settled.clear();
+    space.newQuery(getNumCities());
+    space.touch(origin);
+    space.heuristic[origin] = estimate(origin, target);
+    space.dist[origin] = 0;
+    priority_queue<pair<double, int>, vector<pair<double, int>>,
+                   greater<pair<double, int>>>
+        toExplore;
+    toExplore.emplace(space.heuristic[origin], origin);
+
+    // the heuristic is consistent, so every city settled has its shortest
+    // distance, and a city on a path of length at most stretch times the
+    // distance to target has a key at most that
+    double targetDist = -1;
+    while (!toExplore.empty()) {
+        int current = toExplore.top().second;
+        if (targetDist != -1 && toExplore.top().first > stretch * targetDist) {
+            break;
+        }
+        toExplore.pop();
+        if (space.isSettled(current)) continue;
+        space.settle(current);
+        settled.push_back(current);
+        if (current == target) targetDist = space.dist[current];
+        for (int road = firstRoad[current]; road < firstRoad[current + 1];
+             road++) {
+            int next = roadTarget[road];
+            if (space.isSettled(next)) continue;
+            if (space.touch(next)) {
+                space.heuristic[next] = estimate(next, target);
+            }
+            double distance = space.dist[current] + roadLength[road];
+            if (distance < space.dist[next]) {
+                space.dist[next] = distance;
+                space.prev[next] = current;
+                toExplore.emplace(distance + space.heuristic[next], next);
+            }
+        }
+    }
+    return targetDist;
+}
+
+/* find the shortest path from start to end and up to maxAlternatives
+ * alternatives with the via-node method */
+void CityGraph::findAlternatives(int start, int end, int maxAlternatives,
+                                 vector<vector<int>>& paths,
+                                 SearchSpace& forward,
+                                 SearchSpace& backward) const {
+    paths.clear();
+    if (start == end || components[start] != components[end]) return;
+
+    // a tree from each end covering every city of an alternative, so a via
+    // city v gives the path start -> v in the forward tree, then v -> end in
+    // the backward tree
+    vector<int> forwardSettled;
+    vector<int> backwardSettled;
+    double best = growTree(start, end, MAX_STRETCH, forward, forwardSettled);
+    if (best == -1) return;
+    growTree(end, start, MAX_STRETCH, backward, backwardSettled);
+
+    // a plateau is a chain of roads in both trees, so the via paths of its
+    // cities are all the same, and a shortest path over the chain. Candidate
+    // plateaus are short enough and long enough to be locally optimal, and
+    // those covering most of their path come first
+    vector<pair<double, int>> candidates;
+    for (int city : forwardSettled) {
+        if (!backward.isSettled(city)) continue;
+        // skip the cities inside a plateau, then follow it to its end
+        int previous = forward.prev[city];
+        if (previous != -1 && backward.isSettled(previous) &&
+            backward.prev[previous] == city) {
+            continue;
+        }
+        int last = city;
+        int next = backward.prev[last];
+        while (next != -1 && forward.isSettled(next) &&
+               forward.prev[next] == last) {
+            last = next;
+            next = backward.prev[last];
+        }
+        double length = forward.dist[city] + backward.dist[city];
+        double plateau = forward.dist[last] - forward.dist[city];
+        if (length <= MAX_STRETCH * best && plateau >= MIN_PLATEAU * best) {
+            candidates.emplace_back(length - plateau, last);
+        }
+    }
+    sort(candidates.begin(), candidates.end());
+
+    // the shortest path first, then the candidates sharing little with the
+    // paths chosen so far
+    vector<int> path;
+    for (int city = end; city != -1; city = forward.prev[city]) {
+        path.push_back(city);
+    }
+    reverse(path.begin(), path.end());
+    paths.push_back(path);
+    unordered_set<long long> usedRoads;
+    auto roadKey = [&](int city, int next) {
+        return (long long)min(city, next) * getNumCities() + max(city, next);
+    };
+    for (size_t i = 0; i + 1 < path.size(); i++) {
+        usedRoads.insert(roadKey(path[i], path[i + 1]));
+    }
+    for (const pair<double, int>& candidate : candidates) {
+        if ((int)paths.size() > maxAlternatives) break;
+        int via = candidate.second;
+        path.clear();
+        for (int city = via; city != -1; city = forward.prev[city]) {
+            path.push_back(city);
+        }
+        reverse(path.begin(), path.end());
+        for (int city = backward.prev[via]; city != -1;
+             city = backward.prev[city]) {
+            path.push_back(city);
+        }
+
+        // the 2 halves may cross, giving a loop
+        vector<int> cities(path);
+        sort(cities.begin(), cities.end());
+        if (adjacent_find(cities.begin(), cities.end()) != cities.end()) {
+            continue;
+        }
+        double shared = 0;
+        for (size_t i = 0; i + 1 < path.size(); i++) {
+            if (usedRoads.count(roadKey(path[i], path[i + 1]))) {
+                shared += roadLength[findRoad(path[i], path[i + 1])];
+            }
+        }
+        if (shared > MAX_OVERLAP * best) continue;
+        for (size_t i = 0; i + 1 < path.size(); i++) {
+            usedRoads.insert(roadKey(path[i], path[i + 1]));
+        }
+        paths.push_back(path);
+    }
+}
+
+/* find all cities within budget of source with Dijkstra, by increasing
+ * distance */
+void CityGraph::findReachable(int source, double budget,
+                              vector<pair<int, double>>& reached,
+                              SearchSpace& space) const {
+    reached.clear();
+    space.newQuery(getNumCities());
+    space.touch(source);
+    space.dist[source] = 0;
+    priority_queue<pair<double, int>, vector<pair<double, int>>,
+                   greater<pair<double, int>>>
+        toExplore;
+    toExplore.emplace(0, source);
+
+    while (!toExplore.empty()) {
+        double currentDist = toExplore.top().first;
+        int current = toExplore.top().second;
+        toExplore.pop();
+        // all remaining cities are beyond the budget
+        if (currentDist > budget) break;
+        if (space.isSettled(current)) continue;
+        space.settle(current);
+        reached.emplace_back(current, currentDist);
+
+        for (int road = firstRoad[current]; road < firstRoad[current + 1];
+             road++) {
+            int next = roadTarget[road];
+            if (space.isSettled(next)) continue;
+            space.touch(next);
+            double distance = currentDist + roadLength[road];
+            // cities beyond the budget are never queued
+            if (distance <= budget && distance < space.dist[next]) {
+                space.dist[next] = distance;
+                toExplore.emplace(distance, next);
+            }
+        }
+    }
+}
+
+/* print a path of city ids as (A)-->(B)-->..., or an empty line */
+void CityGraph::printPath(const vector<int>& path, ostream& out) const {
+    string output = "";
+    for (size_t i = 0; i < path.size(); i++) {
+        if (i > 0) output += "-->";
+        output += "(" + getCityName(path[i]) + ")";
+    }
+    out << output << endl;
+}
+
+/* print paths of city ids like printPath, tab-separated on one line */
+void CityGraph::printPaths(const vector<vector<int>>& paths,
+                           ostream& out) const {
+    string output = "";
+    for (size_t p = 0; p < paths.size(); p++) {
+        if (p > 0) output += "\t";
+        for (size_t i = 0; i < paths[p].size(); i++) {
+            if (i > 0) output += "-->";
+            output += "(" + getCityName(paths[p][i]) + ")";
+        }
+    }
+    out << output << endl;
+}
+
+/* compute the distance from every source city to every target city with the
+ * contraction hierarchy */
+void CityGraph::distanceTable(const vector<string>& sources,
+                              const vector<string>& targets,
+                              vector<double>& table, unsigned int numThreads) {
+    if (!indexBuilt) buildIndex();
+    if (!hierarchy) buildHierarchy();
+
+    // unknown cities are searched as city 0, and their distances reset
+    vector<int> sourceIds;
+    vector<int> targetIds;
+    for (const string& source : sources) {
+        sourceIds.push_back(getCityId(source));
+    }
+    for (const string& target : targets) {
+        targetIds.push_back(getCityId(target));
+    }
+    if (getNumCities() == 0) {
+        table.assign(sources.size() * targets.size(), -1);
         return;
     }
+    vector<int> searchedSources(sourceIds);
+    vector<int> searchedTargets(targetIds);
+    replace(searchedSources.begin(), searchedSources.end(), -1, 0);
+    replace(searchedTargets.begin(), searchedTargets.end(), -1, 0);
+    hierarchy->distanceTable(searchedSources, searchedTargets, table,
+                             numThreads);
 
-    CityNode* city = end;
-    string path = "(" + city->name + ")";
-    while (city != start) {
-        city = city->prev;
-        path = "(" + city->name + ")-->" + path;
+    for (size_t i = 0; i < sourceIds.size(); i++) {
+        for (size_t j = 0; j < targetIds.size(); j++) {
+            if (sourceIds[i] == -1 || targetIds[j] == -1) {
+                table[i * targetIds.size() + j] = -1;
+            }
+        }
     }
-    out << path << endl;
+}
+
+/* find a short closed tour through the given stops, starting and ending at
+ * the first one */
+double CityGraph::findTour(const vector<string>& stops, vector<int>& route,
+                           unsigned int numThreads) {
+    route.clear();
+    if (stops.empty()) return -1;
+    vector<double> table;
+    distanceTable(stops, stops, table, numThreads);
+    int numStops = stops.size();
+    if (find(table.begin(), table.end(), -1) != table.end()) return -1;
+
+    vector<int> order;
+    TourPlanner planner(table, numStops);
+    double length = planner.plan(order, TOUR_RESTARTS, numThreads);
+
+    // expand the leg between each stop and the next with the hierarchy
+    route.push_back(getCityId(stops[order[0]]));
+    vector<int> leg;
+    for (int i = 0; i < numStops; i++) {
+        int from = getCityId(stops[order[i]]);
+        int to = getCityId(stops[order[(i + 1) % numStops]]);
+        if (from == to) continue;
+        hierarchy->query(from, to, leg, forward, backward);
+        route.insert(route.end(), leg.begin() + 1, leg.end());
+    }
+    return length;
+}
+
+/* build the contraction hierarchy used by the CONTRACTION_HIERARCHY engine */
+void CityGraph::buildHierarchy() {
+    if (!indexBuilt) buildIndex();
+    delete hierarchy;
+    hierarchy = new ContractionHierarchy();
+    hierarchy->build(*this);
+}
+
+/* build the hub labels used by the HUB_LABELS engine from the contraction
+ * hierarchy */
+void CityGraph::buildHubLabels() {
+    if (!indexBuilt) buildIndex();
+    if (!hierarchy) buildHierarchy();
+    delete hubLabels;
+    hubLabels = new HubLabels();
+    hubLabels->build(*hierarchy);
+}
+
+/* save the hub labels into a binary file, building them first if needed */
+bool CityGraph::saveHubLabels(const char* filename) {
+    if (!indexBuilt || !hubLabels) buildHubLabels();
+    return hubLabels->saveToFile(filename, getGraphHash());
+}
+
+/* map hub labels saved by saveHubLabels for this graph into memory */
+bool CityGraph::loadHubLabels(const char* filename) {
+    if (!indexBuilt) buildIndex();
+    HubLabels* loaded = new HubLabels();
+    // the labels must have been built for the same names and roads
+    if (!loaded->loadFromFile(filename, getGraphHash()) ||
+        loaded->getNumCities() != getNumCities()) {
+        delete loaded;
+        return false;
+    }
+    delete hubLabels;
+    hubLabels = loaded;
+    return true;
+}
+
+/* order the cities and build the customizable hierarchy, then customize it
+ * with the road lengths */
+void CityGraph::buildCustomizableHierarchy(unsigned int numThreads) {
+    if (!indexBuilt) buildIndex();
+    delete customizable;
+    customizable = new CustomizableHierarchy();
+    customizable->build(*this);
+    customizable->customize(
+        vector<double>(roadLength.begin(), roadLength.end()), numThreads);
+}
+
+/* customize the customizable hierarchy with the road weights of a file */
+bool CityGraph::loadRoadWeights(const char* filename, unsigned int numThreads) {
+    if (!indexBuilt || !customizable) buildCustomizableHierarchy(numThreads);
+
+    ifstream infile(filename);
+    if (!infile) return false;
+    vector<double> roadWeights(roadLength.begin(), roadLength.end());
+    string city1, city2;
+    double factor;
+    while (infile >> city1 >> city2 >> factor) {
+        int from = getCityId(city1);
+        int to = getCityId(city2);
+        if (from == -1 || to == -1) continue;
+        // a road cannot be free or shorten the paths through it
+        if (!isfinite(factor) || factor <= 0) return false;
+        // roads go both ways
+        int road = findRoad(from, to);
+        if (road != -1) roadWeights[road] = factor * roadLength[road];
+        road = findRoad(to, from);
+        if (road != -1) roadWeights[road] = factor * roadLength[road];
+    }
+    if (!infile.eof()) return false;
+
+    customizable->customize(roadWeights, numThreads);
+    return true;
+}
+
+/* compute the reach of every city, used by the REACH engine */
+void CityGraph::buildReaches(unsigned int numThreads) {
+    if (!indexBuilt) buildIndex();
+    delete reaches;
+    reaches = new ReachIndex();
+    reaches->build(*this, numThreads);
+}
+
+/* choose the landmarks used by the ALT engine and precompute their distances
+ */
+void CityGraph::buildLandmarks(int numLandmarks, Landmarks::Strategy strategy) {
+    if (!indexBuilt) buildIndex();
+    delete landmarks;
+    landmarks = new Landmarks();
+    landmarks->build(*this, numLandmarks, strategy);
+}
+
+/* save the contraction hierarchy into a binary file, building it first if
+ * needed */
+bool CityGraph::saveHierarchy(const char* filename) {
+    if (!indexBuilt || !hierarchy) buildHierarchy();
+    return hierarchy->saveToFile(filename, getGraphHash());
+}
+
+/* load a contraction hierarchy saved by saveHierarchy for this graph */
+bool CityGraph::loadHierarchy(const char* filename) {
+    if (!indexBuilt) buildIndex();
+    ContractionHierarchy* loaded = new ContractionHierarchy();
+    // the hierarchy must have been built for the same names and roads
+    if (!loaded->loadFromFile(filename, getGraphHash()) ||
+        loaded->getNumCities() != getNumCities()) {
+        delete loaded;
+        return false;
+    }
+    delete hierarchy;
+    hierarchy = loaded;
+    return true;
+}
+
+/* hash size bytes of data into hash with FNV-1a */
+static void hashBytes(unsigned long long& hash, const void* data,
+                      size_t size) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    }
+}
+
+/* return a fingerprint of the city names, the roads and their lengths */
+unsigned long long CityGraph::getGraphHash() {
+    if (!indexBuilt) buildIndex();
+    unsigned long long hash = 14695981039346656037ULL;
+    hashBytes(hash, nameChars.data(), nameChars.size());
+    hashBytes(hash, firstChar.data(), firstChar.size() * sizeof(uint64_t));
+    hashBytes(hash, firstRoad.data(), firstRoad.size() * sizeof(int));
+    hashBytes(hash, roadTarget.data(), roadTarget.size() * sizeof(int));
+    hashBytes(hash, roadLength.data(), roadLength.size() * sizeof(double));
+    return hash;
+}
+
+/* build the compact id-based adjacency arrays (and the component ids) from
+ * the inserted cities and roads */
+void CityGraph::buildIndex() {
+    // number cities in alphabetic order of their names
+    vector<string> names;
+    for (auto itr = cities.begin(); itr != cities.end(); itr++) {
+        names.push_back(itr->first);
+    }
+    sort(names.begin(), names.end());
+
+    int numCities = names.size();
+    unordered_map<string, int> cityIds;
+    vector<char> chars;
+    vector<uint64_t> nameStarts(1, 0);
+    vector<int> order(numCities);
+    vector<double> cityXs(numCities);
+    vector<double> cityYs(numCities);
+    for (int city = 0; city < numCities; city++) {
+        CityNode* node = cities.at(names[city]);
+        cityIds.emplace(names[city], city);
+        chars.insert(chars.end(), names[city].begin(), names[city].end());
+        nameStarts.push_back(chars.size());
+        order[city] = city;
+        cityXs[city] = node->x;
+        cityYs[city] = node->y;
+    }
+
+    // lay out the roads of each city contiguously, sorted by target id, and
+    // compute their lengths once
+    vector<int> roadStarts(1, 0);
+    vector<int> roadTargets;
+    vector<double> roadLengths;
+    for (int city = 0; city < numCities; city++) {
+        vector<int> targets;
+        for (const string& neighbor : cities.at(names[city])->neighbors) {
+            targets.push_back(cityIds.at(neighbor));
+        }
+        sort(targets.begin(), targets.end());
+        for (int next : targets) {
+            roadTargets.push_back(next);
+            roadLengths.push_back(sqrt(pow(cityXs[next] - cityXs[city], 2) +
+                                       pow(cityYs[next] - cityYs[city], 2)));
+        }
+        roadStarts.push_back(roadTargets.size());
+    }
+
+    nameChars.own(move(chars));
+    firstChar.own(move(nameStarts));
+    nameOrder.own(move(order));
+    xs.own(move(cityXs));
+    ys.own(move(cityYs));
+    firstRoad.own(move(roadStarts));
+    roadTarget.own(move(roadTargets));
+    roadLength.own(move(roadLengths));
+
+    // roads are straight lines, so the euclidean distance is a lower bound
+    heuristicScale = c;
+    finishIndex();
+}
+
+/* finish the compact representation once the adjacency arrays are laid out */
+void CityGraph::finishIndex() {
+    buildComponents();
+    spatialIndexBuilt = false;
+
+    // preprocessed engines refer to the old ids, and no array refers to the
+    // previous snapshot anymore
+    deletePreprocessing();
+    releaseSnapshot();
+
+    indexBuilt = true;
+}
+
+/* delete the preprocessing of the engines, which refers to city ids */
+void CityGraph::deletePreprocessing() {
+    delete hierarchy;
+    hierarchy = 0;
+    delete customizable;
+    customizable = 0;
+    delete hubLabels;
+    hubLabels = 0;
+    delete landmarks;
+    landmarks = 0;
+    delete reaches;
+    reaches = 0;
+}
+
+/* unmap the snapshot, once no array refers to it anymore */
+void CityGraph::releaseSnapshot() {
+    if (snapshot) munmap(snapshot, snapshotSize);
+    snapshot = 0;
+    snapshotSize = 0;
+}
+
+/* round a section size up to keep every section 8-byte aligned */
+static size_t aligned(size_t bytes) { return (bytes + 7) / 8 * 8; }
+
+/* write an array as a section of a snapshot */
+template <typename T>
+static void writeSection(ofstream& out, const ArrayView<T>& array) {
+    size_t bytes = array.size() * sizeof(T);
+    const char padding[8] = {0};
+    out.write((const char*)array.data(), bytes);
+    out.write(padding, aligned(bytes) - bytes);
+}
+
+/* hash the sizes and modification times of the source files into stamp,
+ * return false if one of them cannot be found */
+static bool stampSources(const vector<string>& sources,
+                         unsigned long long& stamp) {
+    stamp = 14695981039346656037ULL;
+    for (const string& source : sources) {
+        struct stat status;
+        if (stat(source.c_str(), &status) == -1) return false;
+        long long size = status.st_size;
+        long long time = status.st_mtime;
+        hashBytes(stamp, &size, sizeof(size));
+        hashBytes(stamp, &time, sizeof(time));
+    }
+    return true;
+}
+
+/* save the compact representation and the landmarks and hierarchy, if built,
+ * into a versioned binary snapshot file, stamped with the source files */
+bool CityGraph::saveSnapshot(const char* filename,
+                             const vector<string>& sources) {
+    if (!indexBuilt) buildIndex();
+    SnapshotHeader header;
+    unsigned long long stamp;
+    if (!stampSources(sources, stamp)) return false;
+    copy(SNAPSHOT_MAGIC, SNAPSHOT_MAGIC + sizeof(header.magic), header.magic);
+    header.version = SNAPSHOT_VERSION;
+    header.sourceStamp = stamp;
+    header.flags = (landmarks ? SNAPSHOT_LANDMARKS : 0) |
+                   (hierarchy ? SNAPSHOT_HIERARCHY : 0);
+    header.numCities = getNumCities();
+    header.numNameChars = nameChars.size();
+    header.numRoads = roadTarget.size();
+    header.numLandmarks = landmarks ? landmarks->getLandmarks().size() : 0;
+    header.numRequestedLandmarks = landmarks ? landmarks->getNumRequested() : 0;
+    header.landmarkStrategy = landmarks ? landmarks->getStrategy() : 0;
+    header.numArcs = hierarchy ? hierarchy->getArcTarget().size() : 0;
+    header.heuristicScale = heuristicScale;
+
+    ofstream out(filename, ios::binary);
+    out.write((const char*)&header, sizeof(header));
+    writeSection(out, firstChar);
+    writeSection(out, nameChars);
+    writeSection(out, nameOrder);
+    writeSection(out, xs);
+    writeSection(out, ys);
+    writeSection(out, firstRoad);
+    writeSection(out, roadTarget);
+    writeSection(out, roadLength);
+    writeSection(out, components);
+    if (landmarks) {
+        writeSection(out, landmarks->getLandmarks());
+        writeSection(out, landmarks->getDistances());
+    }
+    if (hierarchy) {
+        writeSection(out, hierarchy->getRank());
+        writeSection(out, hierarchy->getFirstArc());
+        writeSection(out, hierarchy->getArcTarget());
+        writeSection(out, hierarchy->getArcWeight());
+        writeSection(out, hierarchy->getArcMiddle());
+    }
+    return (bool)out;
+}
+
+/* map a snapshot written by saveSnapshot into memory and use its arrays in
+ * place, unless the source files changed since */
+bool CityGraph::loadSnapshot(const char* filename,
+                             const vector<string>& sources) {
+    unsigned long long stamp;
+    if (!stampSources(sources, stamp)) return false;
+    int fd = open(filename, O_RDONLY);
+    if (fd == -1) return false;
+    struct stat status;
+    if (fstat(fd, &status) == -1 ||
+        (size_t)status.st_size < sizeof(SnapshotHeader)) {
+        close(fd);
+        return false;
+    }
+    void* data = mmap(0, status.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return false;
+    char* buffer = (char*)data;
+    size_t bufferSize = status.st_size;
+
+    // only a snapshot of this version can be read in place, and only if it
+    // was saved from the same source files
+    SnapshotHeader header = *(const SnapshotHeader*)buffer;
+    if (!equal(header.magic, header.magic + sizeof(header.magic),
+               SNAPSHOT_MAGIC) ||
+        header.version != SNAPSHOT_VERSION || header.sourceStamp != stamp) {
+        munmap(buffer, bufferSize);
+        return false;
+    }
+
+    // walk through the sections, checking they fit in the file
+    size_t offset = sizeof(SnapshotHeader);
+    auto section = [&](size_t bytes) {
+        const char* start = buffer + offset;
+        offset += aligned(bytes);
+        return start;
+    };
+    uint64_t n = header.numCities;
+    uint64_t numLandmarks = header.numLandmarks;
+    const uint64_t* charStarts =
+        (const uint64_t*)section((n + 1) * sizeof(uint64_t));
+    const char* chars = section(header.numNameChars);
+    const int* order = (const int*)section(n * sizeof(int));
+    const double* cityXs = (const double*)section(n * sizeof(double));
+    const double* cityYs = (const double*)section(n * sizeof(double));
+    const int* roadStarts = (const int*)section((n + 1) * sizeof(int));
+    const int* roadTargets = (const int*)section(header.numRoads * sizeof(int));
+    const double* roadLengths =
+        (const double*)section(header.numRoads * sizeof(double));
+    const int* cityComponents = (const int*)section(n * sizeof(int));
+    const int* landmarkIds = 0;
+    const double* landmarkDists = 0;
+    if (header.flags & SNAPSHOT_LANDMARKS) {
+        landmarkIds = (const int*)section(numLandmarks * sizeof(int));
+        landmarkDists =
+            (const double*)section(n * numLandmarks * sizeof(double));
+    }
+    const int* ranks = 0;
+    const int* arcStarts = 0;
+    const int* arcTargets = 0;
+    const double* arcWeights = 0;
+    const int* arcMiddles = 0;
+    if (header.flags & SNAPSHOT_HIERARCHY) {
+        ranks = (const int*)section(n * sizeof(int));
+        arcStarts = (const int*)section((n + 1) * sizeof(int));
+        arcTargets = (const int*)section(header.numArcs * sizeof(int));
+        arcWeights = (const double*)section(header.numArcs * sizeof(double));
+        arcMiddles = (const int*)section(header.numArcs * sizeof(int));
+    }
+    if (offset != bufferSize || charStarts[n] != header.numNameChars ||
+        (uint64_t)roadStarts[n] != header.numRoads ||
+        (arcStarts && (uint64_t)arcStarts[n] != header.numArcs)) {
+        munmap(buffer, bufferSize);
+        return false;
+    }
+
+    // the snapshot replaces the graph
+    for (auto itr = cities.begin(); itr != cities.end(); itr++) {
+        delete itr->second;
+    }
+    cities.clear();
+    deletePreprocessing();
+    nameChars.refer(chars, header.numNameChars);
+    firstChar.refer(charStarts, n + 1);
+    nameOrder.refer(order, n);
+    xs.refer(cityXs, n);
+    ys.refer(cityYs, n);
+    firstRoad.refer(roadStarts, n + 1);
+    roadTarget.refer(roadTargets, header.numRoads);
+    roadLength.refer(roadLengths, header.numRoads);
+    components.refer(cityComponents, n);
+    heuristicScale = header.heuristicScale;
+    if (landmarkIds) {
+        landmarks = new Landmarks();
+        landmarks->refer(n, landmarkIds, numLandmarks, landmarkDists,
+                         header.numRequestedLandmarks,
+                         (Landmarks::Strategy)header.landmarkStrategy);
+    }
+    if (ranks) {
+        hierarchy = new ContractionHierarchy();
+        hierarchy->refer(n, ranks, arcStarts, header.numArcs, arcTargets,
+                         arcWeights, arcMiddles);
+    }
+    spatialIndexBuilt = false;
+
+    releaseSnapshot();
+    snapshot = buffer;
+    snapshotSize = bufferSize;
+    indexBuilt = true;
+    return true;
+}
+
+/* return the index of the road from city to next in the adjacency arrays, or
+ * -1 if there is none */
+int CityGraph::findRoad(int city, int next) const {
+    auto begin = roadTarget.begin() + firstRoad[city];
+    auto end = roadTarget.begin() + firstRoad[city + 1];
+    auto road = lower_bound(begin, end, next);
+    return road != end && *road == next ? road - roadTarget.begin() : -1;
+}
+
+/* return the id of the city nearest to (x, y), or -1 if there is none */
+int CityGraph::findNearestCity(double x, double y) {
+    vector<int> nearest;
+    findNearestCities(x, y, 1, nearest);
+    return nearest.empty() ? -1 : nearest[0];
+}
+
+/* put the ids of the k cities nearest to (x, y) in cities, nearest first */
+void CityGraph::findNearestCities(double x, double y, int k,
+                                  vector<int>& cities) {
+    if (!indexBuilt) buildIndex();
+    if (!spatialIndexBuilt) {
+        spatialIndex.build(xs.data(), ys.data(), getNumCities());
+        spatialIndexBuilt = true;
+    }
+    spatialIndex.nearest(x, y, k, cities);
+}
+
+/* put the ids of the cities inside the box in cities, in increasing order */
+void CityGraph::findCitiesInBox(double minX, double minY, double maxX,
+                                double maxY, vector<int>& cities) {
+    if (!indexBuilt) buildIndex();
+    if (!spatialIndexBuilt) {
+        spatialIndex.build(xs.data(), ys.data(), getNumCities());
+        spatialIndexBuilt = true;
+    }
+    spatialIndex.inBox(minX, minY, maxX, maxY, cities);
+}
+
+/* return a lower bound of the distance from city to target: the scaled
+ * euclidean distance, or with the ALT engine the landmark bound if
+ * larger */
+double CityGraph::estimate(int city, int target) const {
+    double bound = heuristicScale * sqrt(pow(xs[city] - xs[target], 2) +
+                                         pow(ys[city] - ys[target], 2));
+    // landmarks loaded for ALT leave the other engines as they are
+    if (engine == ALT && landmarks) {
+        bound = max(bound, landmarks->lowerBound(city, target));
+    }
+    return bound;
+}
+
+/* return the id of the given city, or -1 if it does not exist */
+int CityGraph::getCityId(const string& city) {
+    if (!indexBuilt) buildIndex();
+    // binary search of the ids sorted by name
+    auto itr = lower_bound(
+        nameOrder.begin(), nameOrder.end(), city,
+        [&](int id, const string& name) { return compareName(id, name) < 0; });
+    return itr != nameOrder.end() && compareName(*itr, city) == 0 ? *itr : -1;
+}
+
+/* compare the name of city to name like string::compare */
+int CityGraph::compareName(int city, const string& name) const {
+    size_t length = firstChar[city + 1] - firstChar[city];
+    int order = memcmp(nameChars.data() + firstChar[city], name.data(),
+                       min(length, name.size()));
+    if (order != 0) return order;
+    return length < name.size() ? -1 : length > name.size();
+}
+
+/* return the id of the connected component of the given city, or -1 if it
+ * does not exist */
+int CityGraph::getComponent(const string& city) {
+    int id = getCityId(city);
+    return id == -1 ? -1 : components[id];
+}
+
+/* label every city with the id of its connected component so that queries
+ * between different components can be rejected immediately */
+void CityGraph::buildComponents() {
+    vector<int> components(getNumCities(), -1);
+
+    // BFS from every unlabeled city, labeling the whole component
+    int numComponents = 0;
+    for (size_t city = 0; city < components.size(); city++) {
+        if (components[city] != -1) continue;
+        queue<int> toExplore;
+        components[city] = numComponents;
+        toExplore.push(city);
+        while (!toExplore.empty()) {
+            int current = toExplore.front();
+            toExplore.pop();
+            for (int road = firstRoad[current]; road < firstRoad[current + 1];
+                 road++) {
+                int next = roadTarget[road];
+                if (components[next] == -1) {
+                    components[next] = numComponents;
+                    toExplore.push(next);
+                }
+            }
+        }
+        numComponents++;
+    }
+    this->components.own(move(components));
 }
 
 /* helper method to insert city into the graph */
 void CityGraph::insertCity(string city, int x, int y) {
     if (!cities.count(city)) {
+        indexBuilt = false;
         cities.emplace(city, new CityNode(city, x, y));
     }
 }
@@ -106,6 +1145,7 @@ void CityGraph::insertCity(string city, int x, int y) {
 void CityGraph::insertRoad(string city1, string city2) {
     // insert road only if 2 cities both exist
     if (cities.count(city1) && cities.count(city2)) {
+        indexBuilt = false;
         cities.at(city1)->neighbors.insert(city2);
         cities.at(city2)->neighbors.insert(city1);
     }
@@ -196,21 +1236,186 @@ bool CityGraph::loadFromFile(const char* cityxy, const char* citypair) {
     }
     infile2.close();
 
+    buildIndex();
     return true;
 }
 
-/* Constructor for CityNode */
-CityGraph::CityNode::CityNode(string name, int x, int y)
-    : name(name), x(x), y(y) {}
+/* call handle on every line of a file, as a null-terminated string. The file
+ * is read in large blocks rather than line by line. return false if the file
+ * could not be read */
+template <typename Handler>
+static bool forEachLine(const char* filename, Handler handle) {
+    FILE* file = fopen(filename, "rb");
+    if (!file) return false;
+    vector<char> block(1 << 20);
+    size_t kept = 0;  // bytes of an unfinished line from the previous block
+    while (true) {
+        size_t got = fread(block.data() + kept, 1, block.size() - kept, file);
+        size_t size = kept + got;
+        char* data = block.data();
+        size_t begin = 0;
+        while (char* newline =
+                   (char*)memchr(data + begin, '\n', size - begin)) {
+            *newline = '\0';
+            handle(data + begin);
+            begin = newline - data + 1;
+        }
+        kept = size - begin;
+        if (got == 0) {
+            // the last line may have no newline
+            if (kept > 0) {
+                block.resize(size + 1);
+                block[size] = '\0';
+                handle(block.data() + begin);
+            }
+            break;
+        }
+        memmove(data, data + begin, kept);
+        if (kept == block.size()) block.resize(block.size() * 2);
+    }
+    bool read = !ferror(file);
+    fclose(file);
+    return read;
+}
+
+/* load the graph from a DIMACS road network */
+bool CityGraph::loadFromDimacs(const char* grFile, const char* coFile) {
+    // a road while the arcs are being read
+    struct Arc {
+        int from;
+        int to;
+        double weight;
+    };
+    long long numCities = -1;
+    vector<Arc> arcs;
+    bool valid = true;
+    bool read = forEachLine(grFile, [&](char* line) {
+        char* next = line + 1;
+        if (line[0] == 'p') {
+            // "p sp <cities> <arcs>"
+            while (*next == ' ') next++;
+            if (strncmp(next, "sp", 2) != 0) valid = false;
+            numCities = strtoll(next + 2, &next, 10);
+            arcs.reserve(2 * strtoll(next, &next, 10));
+        } else if (line[0] == 'a') {
+            long long from = strtoll(next, &next, 10);
+            long long to = strtoll(next, &next, 10);
+            double weight = strtod(next, &next);
+            if (from < 1 || from > numCities || to < 1 || to > numCities ||
+                weight < 0) {
+                valid = false;
+            } else if (from != to) {
+                arcs.push_back(Arc{(int)from - 1, (int)to - 1, weight});
+                arcs.push_back(Arc{(int)to - 1, (int)from - 1, weight});
+            }
+        }
+    });
+    if (!read || !valid || numCities < 0) {
+        cerr << "Failed to read " << grFile << "!\n";
+        return false;
+    }
+
+    vector<double> cityXs(numCities, 0);
+    vector<double> cityYs(numCities, 0);
+    if (coFile) {
+        read = forEachLine(coFile, [&](char* line) {
+            if (line[0] != 'v') return;
+            char* next = line + 1;
+            long long city = strtoll(next, &next, 10);
+            double x = strtod(next, &next);
+            double y = strtod(next, &next);
+            if (city < 1 || city > numCities) {
+                valid = false;
+            } else {
+                cityXs[city - 1] = x;
+                cityYs[city - 1] = y;
+            }
+        });
+        if (!read || !valid) {
+            cerr << "Failed to read " << coFile << "!\n";
+            return false;
+        }
+    }
+
+    // the graph replaces any inserted cities
+    for (auto itr = cities.begin(); itr != cities.end(); itr++) {
+        delete itr->second;
+    }
+    cities.clear();
+    vector<char> chars;
+    vector<uint64_t> nameStarts(1, 0);
+    for (int city = 0; city < numCities; city++) {
+        string name = to_string(city + 1);
+        chars.insert(chars.end(), name.begin(), name.end());
+        nameStarts.push_back(chars.size());
+    }
 
-/* Comparator of CityNode pointer. */
-bool CityGraph::CityNode::FValueComp::operator()(CityNode* left,
-                                                 CityNode* right) const {
-    if (left->dist + c * left->heuristic ==
-        right->dist + c * right->heuristic) {
-        return left->name > right->name;
+    // the names sorted alphabetically are a preorder walk of the decimal
+    // numbers from 1 to numCities
+    vector<int> order(numCities);
+    long long number = 1;
+    for (int i = 0; i < numCities; i++) {
+        order[i] = number - 1;
+        if (number * 10 <= numCities) {
+            number *= 10;
+        } else {
+            if (number >= numCities) number /= 10;
+            number++;
+            while (number % 10 == 0) number /= 10;
+        }
+    }
+
+    // lay out the roads of each city sorted by target id, keeping the
+    // lightest of parallel arcs
+    sort(arcs.begin(), arcs.end(), [](const Arc& left, const Arc& right) {
+        if (left.from != right.from) return left.from < right.from;
+        if (left.to != right.to) return left.to < right.to;
+        return left.weight < right.weight;
+    });
+    vector<int> roadStarts(numCities + 1, 0);
+    vector<int> roadTargets;
+    vector<double> roadLengths;
+    heuristicScale = HUGE_VAL;
+    for (size_t i = 0; i < arcs.size(); i++) {
+        const Arc& arc = arcs[i];
+        if (i > 0 && arc.from == arcs[i - 1].from &&
+            arc.to == arcs[i - 1].to) {
+            continue;
+        }
+        roadStarts[arc.from + 1]++;
+        roadTargets.push_back(arc.to);
+        roadLengths.push_back(arc.weight);
+
+        // scale the heuristic so that it never exceeds a road weight
+        double euclid = sqrt(pow(cityXs[arc.to] - cityXs[arc.from], 2) +
+                             pow(cityYs[arc.to] - cityYs[arc.from], 2));
+        if (euclid > 0) {
+            heuristicScale = min(heuristicScale, arc.weight / euclid);
+        }
+    }
+    vector<Arc>().swap(arcs);
+    for (int city = 0; city < numCities; city++) {
+        roadStarts[city + 1] += roadStarts[city];
+    }
+    // with a margin for rounding, or no heuristic without coordinates
+    if (heuristicScale == HUGE_VAL) {
+        heuristicScale = 0;
     } else {
-        return left->dist + c * left->heuristic >
-               right->dist + c * right->heuristic;
+        heuristicScale *= 1 - 1e-12;
     }
-}
\ No newline at end of file
+
+    nameChars.own(move(chars));
+    firstChar.own(move(nameStarts));
+    nameOrder.own(move(order));
+    xs.own(move(cityXs));
+    ys.own(move(cityYs));
+    firstRoad.own(move(roadStarts));
+    roadTarget.own(move(roadTargets));
+    roadLength.own(move(roadLengths));
+    finishIndex();
+    return true;
+}
+
+/* Constructor for CityNode */
+CityGraph::CityNode::CityNode(string name, int x, int y)
+    : name(name), x(x), y(y) {}
@@ -9,11 +9,24 @@
 #ifndef CITYGRAPH_HPP
 #define CITYGRAPH_HPP
 
+#include <stdint.h>
 #include <iostream>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
+#include "ArrayView.hpp"
+#include "ContractionHierarchy.hpp"
+#include "CustomizableHierarchy.hpp"
+#include "HubLabels.hpp"
+#include "Landmarks.hpp"
+#include "PathTreeCache.hpp"
+#include "ReachIndex.hpp"
+#include "SearchSpace.hpp"
+#include "SearchStats.hpp"
+#include "SpatialIndex.hpp"
+#include "TourPlanner.hpp"
+
 using namespace std;
 
 /**
@@ -22,6 +35,17 @@ using namespace std;
  */
 class CityGraph {
   public:
+    /* algorithms that find_path can use */
+    enum Engine {
+        ASTAR,                  // A* search with euclidean heuristic
+        ALT,                    // A* search with landmark bounds too
+        BIDIRECTIONAL_ASTAR,    // A* from both ends with averaged potentials
+        REACH,                  // A* search skipping cities of low reach
+        CONTRACTION_HIERARCHY,  // bidirectional upward search in a hierarchy
+        CUSTOMIZABLE_HIERARCHY,  // same, with customizable road weights
+        HUB_LABELS,             // merge of 2 hub labels from a hierarchy
+    };
+
     class CityNode {
       public:
         string name;  // name of the city
@@ -30,34 +54,324 @@ class CityGraph {
 
         unordered_set<string> neighbors;  // adjacency list of neighbor cities
 
-        double dist;       // dist from the start city
-        double heuristic;  // heuristic function value to the target city
-        CityNode* prev;    // previous city in the path
-
         /* Constructor for CityNode */
         CityNode(string name, int x, int y);
-
-        /* Comparator of CityNode pointer. */
-        struct FValueComp {
-            /* a comparator of CityNode pointer.
-             * The node with lower (f = dist+ heuristic) value will have higher
-             * priority If 2 nodes are of the same priority value the node with
-             * name in lower alphebetic order will have higher priority */
-            bool operator()(CityNode* left, CityNode* right) const;
-        };
     };
 
   private:
     unordered_map<string, CityNode*> cities;
 
+    bool indexBuilt;  // whether the compact arrays below are up to date
+
+    /* Compact representation used by the searches, either built here or
+     * mapped from a snapshot file. Cities inserted one by one are numbered
+     * in alphabetic order of their names, so comparing ids compares names */
+    ArrayView<char> nameChars;  // names of all cities, one after the other
+    ArrayView<uint64_t> firstChar;  // name of city i is [firstChar[i], ...)
+    ArrayView<int> nameOrder;    // ids sorted by name, for query boundaries
+    ArrayView<double> xs;        // x-pos of each city
+    ArrayView<double> ys;        // y-pos of each city
+    ArrayView<int> firstRoad;  // roads of city i are [firstRoad[i], ...)
+    ArrayView<int> roadTarget;   // city at the other end of each road
+    ArrayView<double> roadLength;  // euclidean length of each road
+    ArrayView<int> components;   // id of the connected component of each city
+    double heuristicScale;  // euclidean distance times this is a lower bound
+
+    char* snapshot;       // mapped snapshot the arrays refer to, if any
+    size_t snapshotSize;  // size of snapshot in bytes
+
+    SpatialIndex spatialIndex;  // k-d tree of the city positions
+    bool spatialIndexBuilt;     // whether spatialIndex is up to date
+
+    /* search state of the forward and the backward search of find_path */
+    SearchSpace forward;
+    SearchSpace backward;
+
+    /* return a lower bound of the distance from city to target: the scaled
+     * euclidean distance, or with the ALT engine the landmark bound if
+     * larger */
+    double estimate(int city, int target) const;
+
+    Engine engine;                       // algorithm used by find_path
+    ContractionHierarchy* hierarchy;     // optional, built on demand
+    CustomizableHierarchy* customizable;  // optional, built on demand
+    HubLabels* hubLabels;                // optional, built on demand
+    Landmarks* landmarks;                // optional, built on demand
+    ReachIndex* reaches;                 // optional, built on demand
+
+    /* label every city with the id of its connected component so that
+     * queries between different components can be rejected immediately */
+    void buildComponents();
+
+    /* finish the compact representation once the adjacency arrays are laid
+     * out: components, and dropping the preprocessing and the snapshot of
+     * the previous graph */
+    void finishIndex();
+
+    /* delete the preprocessing of the engines, which refers to city ids */
+    void deletePreprocessing();
+
+    /* unmap the snapshot, once no array refers to it anymore */
+    void releaseSnapshot();
+
+    /* compare the name of city to name like string::compare */
+    int compareName(int city, const string& name) const;
+
+    /* find the shortest path between 2 city names for find_path, counting
+     * the effort of the search with counter */
+    template <typename Counter>
+    void findNamedPath(const string& startCityName, const string& endCityName,
+                       ostream& out, Counter& counter);
+
+    /* find the shortest path between 2 city ids with the selected engine for
+     * findPath, counting the effort of the search with counter */
+    template <typename Counter>
+    void searchPath(int start, int end, vector<int>& path,
+                    SearchSpace& forward, SearchSpace& backward,
+                    Counter& counter) const;
+
+    /* find the shortest path from start to end with A* and put its cities in
+     * path (empty if there is no path) */
+    template <typename Counter>
+    void findAStarPath(int start, int end, vector<int>& path,
+                       SearchSpace& space, Counter& counter) const;
+
+    /* find the shortest path from start to end with bidirectional A* and put
+     * its cities in path (empty if there is no path) */
+    template <typename Counter>
+    void findBidirectionalPath(int start, int end, vector<int>& path,
+                               SearchSpace& forward, SearchSpace& backward,
+                               Counter& counter) const;
+
+    /* grow a shortest path tree from origin with A* toward target, going on
+     * after target until the keys exceed stretch times its distance. The
+     * settled cities are put in settled in the order they were settled.
+     * return the distance to target, or -1 if it cannot be reached */
+    double growTree(int origin, int target, double stretch, SearchSpace& space,
+                    vector<int>& settled) const;
+
   public:
     /* Constructor of CityGraph */
     CityGraph(void);
 
-    /* find the shortest path from start city to target city using A* Algorithm
-     */
+    /* find the shortest path from start city to target city using the
+     * selected engine (A* Algorithm by default) */
     void find_path(string startCityName, string endCityName, ostream& out);
 
+    /* find the shortest path like find_path and put the effort of the
+     * search in stats. The cch and hl engines do not count theirs */
+    void find_path(string startCityName, string endCityName, ostream& out,
+                   SearchStats& stats);
+
+    /* select the algorithm used by find_path */
+    void setEngine(Engine engine) { this->engine = engine; }
+
+    /* build the index and whatever the selected engine needs, so that
+     * findPath can then be called on a const graph */
+    void prepareEngine();
+
+    /**
+     * Find the shortest path between 2 city ids with the selected engine and
+     * put its cities in path (empty if there is no path or start == end).
+     * prepareEngine must have been called. The graph is not modified, so
+     * threads can search it concurrently, each with its own search state.
+     */
+    void findPath(int start, int end, vector<int>& path, SearchSpace& forward,
+                  SearchSpace& backward) const;
+
+    /* find the shortest path like findPath and put the effort of the search
+     * in stats. The cch and hl engines do not count theirs */
+    void findPath(int start, int end, vector<int>& path, SearchSpace& forward,
+                  SearchSpace& backward, SearchStats& stats) const;
+
+    /**
+     * Find the shortest path between 2 city ids like findPath, with the
+     * shortest path tree of start in cache, grown by Dijkstra only as far as
+     * end. More targets of start are then mostly a walk up the tree. The
+     * graph is not modified, so threads can search it concurrently, each
+     * with its own cache.
+     */
+    void findTreePath(int start, int end, vector<int>& path,
+                      PathTreeCache& cache) const;
+
+    /* return whether findTreePath can stand in for findPath with the selected
+     * engine: the trees follow the road lengths, not customized weights, and
+     * engines searching from a hierarchy are faster than a tree anyway */
+    bool usesPathTrees() const {
+        return engine == ASTAR || engine == ALT ||
+               engine == BIDIRECTIONAL_ASTAR || engine == REACH;
+    }
+
+    /* print a path of city ids as (A)-->(B)-->..., or an empty line */
+    void printPath(const vector<int>& path, ostream& out) const;
+
+    /**
+     * Find the shortest path from start to end and up to maxAlternatives
+     * alternatives with the via-node method, and put their cities in paths,
+     * the shortest first (none if there is no path or start == end). An
+     * alternative is at most 25% longer than the shortest path, shares at
+     * most 80% of its length with the paths before it, and is a shortest
+     * path over at least a quarter of that length. The graph is not
+     * modified, so threads can search it concurrently, each with its own
+     * search state.
+     */
+    void findAlternatives(int start, int end, int maxAlternatives,
+                          vector<vector<int>>& paths, SearchSpace& forward,
+                          SearchSpace& backward) const;
+
+    /* print paths of city ids like printPath, tab-separated on one line */
+    void printPaths(const vector<vector<int>>& paths, ostream& out) const;
+
+    /**
+     * Find all cities within budget of source with Dijkstra, stopping as soon
+     * as the next city is farther than budget. Their (id, dist) pairs are put
+     * in reached by increasing distance. The graph is not modified, so
+     * threads can search it concurrently, each with its own search state.
+     */
+    void findReachable(int source, double budget,
+                       vector<pair<int, double>>& reached,
+                       SearchSpace& space) const;
+
+    /* compute the distance from every source city to every target city with
+     * the contraction hierarchy, built first if needed. The distance from
+     * sources[i] to targets[j] is put in table[i * targets.size() + j], or -1
+     * if there is no path or a city does not exist */
+    void distanceTable(const vector<string>& sources,
+                       const vector<string>& targets, vector<double>& table,
+                       unsigned int numThreads = 1);
+
+    /**
+     * Find a short closed tour through the given stops, starting and ending
+     * at the first one. The distances between all stops come from
+     * distanceTable, the order from a TourPlanner with numThreads threads,
+     * and the cities of the whole route, every leg expanded, are put in
+     * route. return its length, or -1 (and an empty route) if a stop does
+     * not exist or cannot be reached from the others
+     */
+    double findTour(const vector<string>& stops, vector<int>& route,
+                    unsigned int numThreads = 1);
+
+    /* build the contraction hierarchy used by the CONTRACTION_HIERARCHY
+     * engine. Called lazily by the first query that needs it */
+    void buildHierarchy();
+
+    /* build the hub labels used by the HUB_LABELS engine from the contraction
+     * hierarchy, built first if needed. Called lazily by the first query
+     * that needs them */
+    void buildHubLabels();
+
+    /**
+     * Save the hub labels into a binary file, building them first if needed.
+     * return true if file was written sucessfully, false otherwise
+     */
+    bool saveHubLabels(const char* filename);
+
+    /**
+     * Map hub labels saved by saveHubLabels for this graph into memory,
+     * refused if they were built for other names, roads or road lengths.
+     * return true if file was loaded sucessfully, false otherwise
+     */
+    bool loadHubLabels(const char* filename);
+
+    /* order the cities and build the customizable hierarchy used by the
+     * CUSTOMIZABLE_HIERARCHY engine, then customize it with the road lengths.
+     * Called lazily by the first query that needs it */
+    void buildCustomizableHierarchy(unsigned int numThreads = 1);
+
+    /**
+     * Customize the customizable hierarchy (built first if needed) with the
+     * road weights of a file of "city1 city2 factor" lines: the road between
+     * city1 and city2 weighs factor times its length, and other roads weigh
+     * their length. Queries already running, even on other threads, finish
+     * with the previous weights. A factor must be finite and positive.
+     * return true if file was loaded sucessfully, false otherwise
+     */
+    bool loadRoadWeights(const char* filename, unsigned int numThreads = 1);
+
+    /* compute the reach of every city, used by the REACH engine, with
+     * numThreads threads. Called lazily by the first query that needs it */
+    void buildReaches(unsigned int numThreads = 1);
+
+    /* choose the landmarks used by the ALT engine and precompute their
+     * distances. Called lazily with default settings by the first query that
+     * needs them */
+    void buildLandmarks(int numLandmarks = 8,
+                        Landmarks::Strategy strategy = Landmarks::FARTHEST);
+
+    /* return whether the landmarks of the ALT engine are built */
+    bool hasLandmarks() const { return landmarks; }
+
+    /* return whether the landmarks of the ALT engine are built, with the
+     * same settings as buildLandmarks(numLandmarks, strategy) */
+    bool hasLandmarks(int numLandmarks, Landmarks::Strategy strategy) const {
+        return landmarks && landmarks->getNumRequested() == numLandmarks &&
+               landmarks->getStrategy() == strategy;
+    }
+
+    /**
+     * Save the contraction hierarchy into a binary file, building it first if
+     * needed. return true if file was written sucessfully, false otherwise
+     */
+    bool saveHierarchy(const char* filename);
+
+    /**
+     * Load a contraction hierarchy saved by saveHierarchy for this graph,
+     * refused if it was built for other names, roads or road lengths.
+     * return true if file was loaded sucessfully, false otherwise
+     */
+    bool loadHierarchy(const char* filename);
+
+    /* return a fingerprint of the city names, the roads and their lengths,
+     * saved with the preprocessing so it is only loaded for this graph */
+    unsigned long long getGraphHash();
+
+    /**
+     * Save the compact representation (names, positions, roads and component
+     * ids) and the landmarks and contraction hierarchy, if built, into a
+     * versioned binary snapshot file, stamped with the sizes and modification
+     * times of sources, the files the graph was read from.
+     *
+     * return true if file was written sucessfully, false otherwise
+     */
+    bool saveSnapshot(const char* filename,
+                      const vector<string>& sources = vector<string>());
+
+    /**
+     * Map a snapshot written by saveSnapshot into memory and use its arrays
+     * in place, so loading takes the same time whatever the size of the
+     * graph. The snapshot replaces the graph, which cannot be extended with
+     * insertCity or insertRoad afterwards. The snapshot is refused if
+     * sources differ from the files it was saved with or changed since.
+     *
+     * return true if file was loaded sucessfully, false otherwise
+     */
+    bool loadSnapshot(const char* filename,
+                      const vector<string>& sources = vector<string>());
+
+    /* build the compact id-based adjacency arrays (and the component ids)
+     * from the inserted cities and roads. Called by loadFromFile, and lazily
+     * by queries after insertCity or insertRoad */
+    void buildIndex();
+
+    /* return the id of the given city, or -1 if it does not exist */
+    int getCityId(const string& city);
+
+    /* return the id of the city nearest to (x, y), or -1 if there is none */
+    int findNearestCity(double x, double y);
+
+    /* put the ids of the k cities nearest to (x, y) in cities, nearest
+     * first */
+    void findNearestCities(double x, double y, int k, vector<int>& cities);
+
+    /* put the ids of the cities with minX <= x <= maxX and minY <= y <= maxY
+     * in cities, in increasing order */
+    void findCitiesInBox(double minX, double minY, double maxX, double maxY,
+                         vector<int>& cities);
+
+    /* return the id of the connected component of the given city, or -1 if
+     * it does not exist */
+    int getComponent(const string& city);
+
     /* helper method to insert city into the graph */
     void insertCity(string city, int x, int y);
 
@@ -73,6 +387,41 @@ class CityGraph {
      */
     bool loadFromFile(const char* cityxy, const char* citypair);
 
+    /**
+     * Load the graph from a DIMACS road network: a .gr file of "a u v w"
+     * arcs and an optional .co file of "v id x y" coordinates (null to skip
+     * it). Both files are streamed straight into the compact representation,
+     * city i is named after its DIMACS id i + 1, and every arc also gives the
+     * road back. The euclidean heuristic is scaled to stay a lower bound of
+     * the arc weights. The graph cannot be extended with insertCity or
+     * insertRoad afterwards.
+     *
+     * return true if files were loaded sucessfully, false otherwise
+     */
+    bool loadFromDimacs(const char* grFile, const char* coFile);
+
+    /* return the number of cities in the compact representation */
+    int getNumCities() const { return nameOrder.size(); }
+
+    /* return the name of the city with the given id */
+    string getCityName(int city) const {
+        return string(nameChars.data() + firstChar[city],
+                      firstChar[city + 1] - firstChar[city]);
+    }
+
+    /* return the position of the city with the given id */
+    double getCityX(int city) const { return xs[city]; }
+    double getCityY(int city) const { return ys[city]; }
+
+    /* return the index of the road from city to next in the adjacency
+     * arrays, or -1 if there is none */
+    int findRoad(int city, int next) const;
+
+    /* return the compact adjacency arrays, for the preprocessing engines */
+    const ArrayView<int>& getFirstRoad() const { return firstRoad; }
+    const ArrayView<int>& getRoadTarget() const { return roadTarget; }
+    const ArrayView<double>& getRoadLength() const { return roadLength; }
+
     /* return the copy of unordered_map cities for debugging */
     unordered_map<string, CityNode*> getCities() { return cities; }
 
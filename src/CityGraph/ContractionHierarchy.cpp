@@ -0,0 +1,576 @@
+/*
+ * ContractionHierarchy.cpp
+ * Author: Yuening YANG, Shenlang ZHOU
+ *
+ * This file shows the implementation details of ContractionHierarchy class
+ * methods, which are declared in 'ContractionHierarchy.hpp' file.
+ */
+
+#include "ContractionHierarchy.hpp"
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "CityGraph.hpp"
+
+using namespace std;
+
+const int WITNESS_SETTLE_LIMIT = 500;  // max cities settled by witness search
+const char CH_FILE_MAGIC[8] = "CHIER02";  // header of hierarchy files
+
+/* min-priority queue of (dist, city) pairs */
+typedef priority_queue<pair<double, int>, vector<pair<double, int>>,
+                       greater<pair<double, int>>>
+    DistQueue;
+
+/* a road or shortcut of the graph while it is being contracted */
+struct ContractionArc {
+    int target;     // city at the other end
+    double weight;  // length of the road or shortcut
+    int middle;     // city bypassed by a shortcut, -1 for a road
+};
+
+/* a shortcut that the contraction of a city requires */
+struct Shortcut {
+    int from;
+    int to;
+    double weight;
+};
+
+/* local Dijkstra used to check whether a shortcut is needed */
+class WitnessSearch {
+  private:
+    vector<double> dist;
+    vector<unsigned int> reachedStamp;
+    unsigned int queryStamp;
+
+  public:
+    /* Constructor of WitnessSearch for a graph of numCities cities */
+    explicit WitnessSearch(int numCities)
+        : dist(numCities), reachedStamp(numCities, 0), queryStamp(0) {}
+
+    /* run Dijkstra from start in the remaining graph, ignoring the city being
+     * contracted, until distances beyond maxDist or the settle limit */
+    void run(const vector<vector<ContractionArc>>& arcs, int start,
+             int ignored, double maxDist) {
+        queryStamp++;
+        reachedStamp[start] = queryStamp;
+        dist[start] = 0;
+        DistQueue toExplore;
+        toExplore.emplace(0, start);
+        int settled = 0;
+        while (!toExplore.empty() && settled < WITNESS_SETTLE_LIMIT) {
+            double currentDist = toExplore.top().first;
+            int current = toExplore.top().second;
+            toExplore.pop();
+            if (currentDist > dist[current]) continue;
+            if (currentDist > maxDist) break;
+            settled++;
+            for (const ContractionArc& arc : arcs[current]) {
+                if (arc.target == ignored) continue;
+                double distance = currentDist + arc.weight;
+                if (reachedStamp[arc.target] != queryStamp ||
+                    distance < dist[arc.target]) {
+                    reachedStamp[arc.target] = queryStamp;
+                    dist[arc.target] = distance;
+                    toExplore.emplace(distance, arc.target);
+                }
+            }
+        }
+    }
+
+    /* return the distance found to city by the last run */
+    double getDist(int city) const {
+        return reachedStamp[city] == queryStamp ? dist[city] : INT32_MAX;
+    }
+};
+
+/* find the shortcuts needed to contract city */
+static void findShortcuts(const vector<vector<ContractionArc>>& arcs, int city,
+                          WitnessSearch& witness, vector<Shortcut>& shortcuts) {
+    shortcuts.clear();
+    const vector<ContractionArc>& neighbors = arcs[city];
+    for (size_t i = 0; i < neighbors.size(); i++) {
+        // longest path through city between neighbor i and a later neighbor
+        double maxDist = 0;
+        for (size_t j = i + 1; j < neighbors.size(); j++) {
+            maxDist = max(maxDist, neighbors[i].weight + neighbors[j].weight);
+        }
+        if (maxDist == 0) continue;
+
+        witness.run(arcs, neighbors[i].target, city, maxDist);
+        for (size_t j = i + 1; j < neighbors.size(); j++) {
+            double viaDist = neighbors[i].weight + neighbors[j].weight;
+            // a shortcut is needed unless a witness path is as short
+            if (witness.getDist(neighbors[j].target) > viaDist) {
+                shortcuts.push_back(
+                    {neighbors[i].target, neighbors[j].target, viaDist});
+            }
+        }
+    }
+}
+
+/* add an arc from city to target, or shorten the existing one */
+static void addArc(vector<ContractionArc>& cityArcs, int target, double weight,
+                   int middle) {
+    for (ContractionArc& arc : cityArcs) {
+        if (arc.target == target) {
+            if (weight < arc.weight) {
+                arc.weight = weight;
+                arc.middle = middle;
+            }
+            return;
+        }
+    }
+    cityArcs.push_back({target, weight, middle});
+}
+
+/* Constructor of an empty ContractionHierarchy */
+ContractionHierarchy::ContractionHierarchy(void) : numCities(0) {
+    firstArc.own(vector<int>(1, 0));
+}
+
+/* contract all cities of the graph and build the upward graph */
+void ContractionHierarchy::build(const CityGraph& graph) {
+    numCities = graph.getNumCities();
+    const ArrayView<int>& firstRoad = graph.getFirstRoad();
+    const ArrayView<int>& roadTarget = graph.getRoadTarget();
+    const ArrayView<double>& roadLength = graph.getRoadLength();
+
+    // copy the roads into a graph that can be modified
+    vector<vector<ContractionArc>> arcs(numCities);
+    for (int city = 0; city < numCities; city++) {
+        for (int road = firstRoad[city]; road < firstRoad[city + 1]; road++) {
+            if (roadTarget[road] != city) {
+                arcs[city].push_back({roadTarget[road], roadLength[road], -1});
+            }
+        }
+    }
+
+    // the priority of a city is its edge difference (shortcuts added minus
+    // roads removed) plus its number of contracted neighbors, which spreads
+    // the contraction evenly over the graph
+    WitnessSearch witness(numCities);
+    vector<Shortcut> shortcuts;
+    vector<int> contractedNeighbors(numCities, 0);
+    vector<int> priority(numCities);
+    auto computePriority = [&](int city) {
+        findShortcuts(arcs, city, witness, shortcuts);
+        return (int)shortcuts.size() - (int)arcs[city].size() +
+               contractedNeighbors[city];
+    };
+
+    priority_queue<pair<int, int>, vector<pair<int, int>>,
+                   greater<pair<int, int>>>
+        toContract;
+    for (int city = 0; city < numCities; city++) {
+        priority[city] = computePriority(city);
+        toContract.emplace(priority[city], city);
+    }
+
+    vector<int> rank(numCities, -1);
+    vector<vector<ContractionArc>> upward(numCities);
+    int nextRank = 0;
+    while (!toContract.empty()) {
+        int city = toContract.top().second;
+        int cityPriority = toContract.top().first;
+        toContract.pop();
+        // skip cities already contracted or with an outdated priority
+        if (rank[city] != -1 || cityPriority != priority[city]) continue;
+
+        // lazy update: if the priority grew, contract the city later
+        priority[city] = computePriority(city);
+        if (!toContract.empty() && priority[city] > toContract.top().first) {
+            toContract.emplace(priority[city], city);
+            continue;
+        }
+
+        // contract the city. Its remaining arcs all lead to cities of higher
+        // rank and become its upward arcs
+        rank[city] = nextRank++;
+        upward[city] = arcs[city];
+        for (const ContractionArc& arc : arcs[city]) {
+            vector<ContractionArc>& neighborArcs = arcs[arc.target];
+            for (size_t i = 0; i < neighborArcs.size(); i++) {
+                if (neighborArcs[i].target == city) {
+                    neighborArcs.erase(neighborArcs.begin() + i);
+                    break;
+                }
+            }
+            contractedNeighbors[arc.target]++;
+        }
+        for (const Shortcut& shortcut : shortcuts) {
+            addArc(arcs[shortcut.from], shortcut.to, shortcut.weight, city);
+            addArc(arcs[shortcut.to], shortcut.from, shortcut.weight, city);
+        }
+        arcs[city].clear();
+
+        // the neighbors now have different priorities
+        for (const ContractionArc& arc : upward[city]) {
+            priority[arc.target] = computePriority(arc.target);
+            toContract.emplace(priority[arc.target], arc.target);
+        }
+    }
+
+    // lay out the upward arcs of each city contiguously
+    vector<int> firstArc(1, 0);
+    vector<int> arcTarget;
+    vector<double> arcWeight;
+    vector<int> arcMiddle;
+    for (int city = 0; city < numCities; city++) {
+        for (const ContractionArc& arc : upward[city]) {
+            arcTarget.push_back(arc.target);
+            arcWeight.push_back(arc.weight);
+            arcMiddle.push_back(arc.middle);
+        }
+        firstArc.push_back(arcTarget.size());
+    }
+    this->rank.own(move(rank));
+    this->firstArc.own(move(firstArc));
+    this->arcTarget.own(move(arcTarget));
+    this->arcWeight.own(move(arcWeight));
+    this->arcMiddle.own(move(arcMiddle));
+}
+
+/* use arrays stored elsewhere as the hierarchy */
+void ContractionHierarchy::refer(int numCities, const int* rank,
+                                 const int* firstArc, size_t numArcs,
+                                 const int* arcTarget, const double* arcWeight,
+                                 const int* arcMiddle) {
+    this->numCities = numCities;
+    this->rank.refer(rank, numCities);
+    this->firstArc.refer(firstArc, numCities + 1);
+    this->arcTarget.refer(arcTarget, numArcs);
+    this->arcWeight.refer(arcWeight, numArcs);
+    this->arcMiddle.refer(arcMiddle, numArcs);
+}
+
+/* find the shortest path from start to end, searching with the given forward
+ * and backward search state. The cities of the path are put in path, and its
+ * length is returned (-1 if there is no path) */
+double ContractionHierarchy::query(int start, int end, vector<int>& path,
+                                   SearchSpace& forward,
+                                   SearchSpace& backward) const {
+    NoCounting counter;
+    return query(start, end, path, forward, backward, counter);
+}
+
+/* find the shortest path like query, counting the effort of the search with
+ * counter */
+template <typename Counter>
+double ContractionHierarchy::query(int start, int end, vector<int>& path,
+                                   SearchSpace& forward, SearchSpace& backward,
+                                   Counter& counter) const {
+    path.clear();
+
+    // forward search from start and backward search from end, both upward
+    SearchSpace* spaces[2] = {&forward, &backward};
+    DistQueue toExplore[2];
+    int origins[2] = {start, end};
+    for (int dir = 0; dir < 2; dir++) {
+        spaces[dir]->newQuery(numCities);
+        spaces[dir]->touch(origins[dir]);
+        spaces[dir]->dist[origins[dir]] = 0;
+        toExplore[dir].emplace(0, origins[dir]);
+        counter.push(toExplore[dir].size());
+    }
+
+    double best = INT32_MAX;
+    int meeting = -1;
+    while (!toExplore[0].empty() || !toExplore[1].empty()) {
+        for (int dir = 0; dir < 2; dir++) {
+            if (toExplore[dir].empty()) continue;
+            SearchSpace& space = *spaces[dir];
+            SearchSpace& other = *spaces[1 - dir];
+            double currentDist = toExplore[dir].top().first;
+            int current = toExplore[dir].top().second;
+            toExplore[dir].pop();
+            counter.pop();
+            // a direction is done once it cannot improve the best path
+            if (currentDist >= best) {
+                toExplore[dir] = DistQueue();
+                continue;
+            }
+            if (currentDist > space.dist[current]) {
+                counter.stalePop();
+                continue;
+            }
+            counter.settle();
+
+            // check whether the other search already reached this city
+            if (other.isReached(current) &&
+                currentDist + other.dist[current] < best) {
+                best = currentDist + other.dist[current];
+                meeting = current;
+            }
+
+            for (int arc = firstArc[current]; arc < firstArc[current + 1];
+                 arc++) {
+                counter.scan();
+                int next = arcTarget[arc];
+                double distance = currentDist + arcWeight[arc];
+                space.touch(next);
+                if (distance < space.dist[next]) {
+                    space.dist[next] = distance;
+                    space.prev[next] = current;
+                    toExplore[dir].emplace(distance, next);
+                    counter.push(toExplore[dir].size());
+                }
+            }
+        }
+    }
+
+    if (meeting == -1) return -1;
+
+    // cities from start up to the meeting city, then down to end
+    vector<int> upPath;
+    for (int city = meeting; city != -1; city = forward.prev[city]) {
+        upPath.push_back(city);
+    }
+    reverse(upPath.begin(), upPath.end());
+    vector<int> hierarchyPath = upPath;
+    for (int city = backward.prev[meeting]; city != -1;
+         city = backward.prev[city]) {
+        hierarchyPath.push_back(city);
+    }
+
+    // replace the shortcuts by the roads they stand for
+    path.push_back(start);
+    for (size_t i = 0; i + 1 < hierarchyPath.size(); i++) {
+        unpackArc(hierarchyPath[i], hierarchyPath[i + 1], path);
+    }
+    return best;
+}
+
+/* append the cities on the road or shortcut from city to next to path,
+ * excluding city itself */
+void ContractionHierarchy::unpackArc(int city, int next,
+                                     vector<int>& path) const {
+    // the arc is stored with the endpoint of lower rank
+    int lower = rank[city] < rank[next] ? city : next;
+    int higher = lower == city ? next : city;
+    int middle = -1;
+    for (int arc = firstArc[lower]; arc < firstArc[lower + 1]; arc++) {
+        if (arcTarget[arc] == higher) {
+            middle = arcMiddle[arc];
+            break;
+        }
+    }
+
+    if (middle == -1) {
+        path.push_back(next);
+    } else {
+        unpackArc(city, middle, path);
+        unpackArc(middle, next, path);
+    }
+}
+
+/* settle every city reachable upward from origin, putting their ids in reached
+ * and their distances in space */
+void ContractionHierarchy::upwardSearch(int origin, SearchSpace& space,
+                                        vector<int>& reached) const {
+    reached.clear();
+    space.newQuery(numCities);
+    space.touch(origin);
+    space.dist[origin] = 0;
+    DistQueue toExplore;
+    toExplore.emplace(0, origin);
+
+    while (!toExplore.empty()) {
+        int current = toExplore.top().second;
+        toExplore.pop();
+        if (space.isSettled(current)) continue;
+        space.settle(current);
+        reached.push_back(current);
+
+        for (int arc = firstArc[current]; arc < firstArc[current + 1]; arc++) {
+            int next = arcTarget[arc];
+            double distance = space.dist[current] + arcWeight[arc];
+            space.touch(next);
+            if (distance < space.dist[next]) {
+                space.dist[next] = distance;
+                toExplore.emplace(distance, next);
+            }
+        }
+    }
+}
+
+/* compute the distance from every source to every target with buckets */
+void ContractionHierarchy::distanceTable(const vector<int>& sources,
+                                         const vector<int>& targets,
+                                         vector<double>& table,
+                                         unsigned int numThreads) const {
+    if (numThreads < 1) numThreads = 1;
+
+    // upward search from every target. Each thread collects the (city,
+    // target index, dist) entries of its share of the targets
+    struct BucketEntry {
+        int city;
+        int target;
+        double dist;
+    };
+    vector<vector<BucketEntry>> entries(numThreads);
+    vector<thread> workers;
+    for (unsigned int t = 0; t < numThreads; t++) {
+        workers.emplace_back([&, t]() {
+            SearchSpace space;
+            vector<int> reached;
+            for (size_t j = t; j < targets.size(); j += numThreads) {
+                upwardSearch(targets[j], space, reached);
+                for (int city : reached) {
+                    entries[t].push_back({city, (int)j, space.dist[city]});
+                }
+            }
+        });
+    }
+    for (thread& worker : workers) {
+        worker.join();
+    }
+
+    // group the entries by city, the bucket of city i is
+    // [firstBucket[i], firstBucket[i+1])
+    vector<int> firstBucket(numCities + 1, 0);
+    for (const vector<BucketEntry>& threadEntries : entries) {
+        for (const BucketEntry& entry : threadEntries) {
+            firstBucket[entry.city + 1]++;
+        }
+    }
+    for (int city = 0; city < numCities; city++) {
+        firstBucket[city + 1] += firstBucket[city];
+    }
+    vector<int> bucketTarget(firstBucket.back());
+    vector<double> bucketDist(firstBucket.back());
+    vector<int> nextSlot(firstBucket.begin(), firstBucket.end() - 1);
+    for (vector<BucketEntry>& threadEntries : entries) {
+        for (const BucketEntry& entry : threadEntries) {
+            bucketTarget[nextSlot[entry.city]] = entry.target;
+            bucketDist[nextSlot[entry.city]++] = entry.dist;
+        }
+        vector<BucketEntry>().swap(threadEntries);
+    }
+
+    // upward search from every source, scanning the buckets it settles
+    table.assign(sources.size() * targets.size(), INT32_MAX);
+    workers.clear();
+    for (unsigned int t = 0; t < numThreads; t++) {
+        workers.emplace_back([&, t]() {
+            SearchSpace space;
+            vector<int> reached;
+            for (size_t i = t; i < sources.size(); i += numThreads) {
+                upwardSearch(sources[i], space, reached);
+                double* row = table.data() + i * targets.size();
+                for (int city : reached) {
+                    for (int b = firstBucket[city]; b < firstBucket[city + 1];
+                         b++) {
+                        row[bucketTarget[b]] =
+                            min(row[bucketTarget[b]],
+                                space.dist[city] + bucketDist[b]);
+                    }
+                }
+                for (size_t j = 0; j < targets.size(); j++) {
+                    if (row[j] == INT32_MAX) row[j] = -1;
+                }
+            }
+        });
+    }
+    for (thread& worker : workers) {
+        worker.join();
+    }
+}
+
+/* return the number of shortcuts added by the contraction */
+int ContractionHierarchy::getNumShortcuts() const {
+    return count_if(arcMiddle.begin(), arcMiddle.end(),
+                    [](int middle) { return middle != -1; });
+}
+
+/* write an array with its size into a binary stream */
+template <typename T>
+static void writeArray(ofstream& out, const ArrayView<T>& array) {
+    unsigned long long size = array.size();
+    out.write((const char*)&size, sizeof(size));
+    out.write((const char*)array.data(), size * sizeof(T));
+}
+
+/* read an array written by writeArray from a binary stream of fileSize bytes,
+ * return false before allocating it if its size is not the expected one or
+ * longer than the rest of the stream */
+template <typename T>
+static bool readArray(ifstream& in, ArrayView<T>& array,
+                      unsigned long long expected,
+                      unsigned long long fileSize) {
+    unsigned long long size = 0;
+    if (!in.read((char*)&size, sizeof(size)) || size != expected) {
+        return false;
+    }
+    unsigned long long left = fileSize - (unsigned long long)in.tellg();
+    if (size > left / sizeof(T)) return false;
+    vector<T> values(size);
+    if (!in.read((char*)values.data(), size * sizeof(T))) return false;
+    array.own(move(values));
+    return true;
+}
+
+/* save the hierarchy into a binary file, along with the fingerprint of the
+ * graph it was built from */
+bool ContractionHierarchy::saveToFile(const char* filename,
+                                      unsigned long long graphHash) const {
+    ofstream out(filename, ios::binary);
+    out.write(CH_FILE_MAGIC, sizeof(CH_FILE_MAGIC));
+    out.write((const char*)&graphHash, sizeof(graphHash));
+    out.write((const char*)&numCities, sizeof(numCities));
+    writeArray(out, rank);
+    writeArray(out, firstArc);
+    writeArray(out, arcTarget);
+    writeArray(out, arcWeight);
+    writeArray(out, arcMiddle);
+    return (bool)out;
+}
+
+/* load the hierarchy from a binary file written by saveToFile for the graph
+ * with the given fingerprint */
+bool ContractionHierarchy::loadFromFile(const char* filename,
+                                        unsigned long long graphHash) {
+    ifstream in(filename, ios::binary | ios::ate);
+    if (!in) return false;
+    unsigned long long fileSize = in.tellg();
+    in.seekg(0);
+    char magic[sizeof(CH_FILE_MAGIC)];
+    if (!in.read(magic, sizeof(magic)) ||
+        !equal(magic, magic + sizeof(magic), CH_FILE_MAGIC)) {
+        return false;
+    }
+    // the hierarchy must have been built for this graph
+    unsigned long long savedHash = 0;
+    if (!in.read((char*)&savedHash, sizeof(savedHash)) ||
+        savedHash != graphHash) {
+        return false;
+    }
+    if (!in.read((char*)&numCities, sizeof(numCities)) || numCities < 0) {
+        return false;
+    }
+    // the arrays must be consistent with each other
+    if (!readArray(in, rank, numCities, fileSize) ||
+        !readArray(in, firstArc, numCities + 1, fileSize) ||
+        firstArc[0] != 0) {
+        return false;
+    }
+    for (int city = 0; city < numCities; city++) {
+        if (firstArc[city + 1] < firstArc[city]) return false;
+    }
+    int numArcs = firstArc[numCities];
+    return readArray(in, arcTarget, numArcs, fileSize) &&
+           readArray(in, arcWeight, numArcs, fileSize) &&
+           readArray(in, arcMiddle, numArcs, fileSize);
+}
+
+// the counting policies used by CityGraph
+template double ContractionHierarchy::query<NoCounting>(
+    int start, int end, vector<int>& path, SearchSpace& forward,
+    SearchSpace& backward, NoCounting& counter) const;
+template double ContractionHierarchy::query<Counting>(
+    int start, int end, vector<int>& path, SearchSpace& forward,
+    SearchSpace& backward, Counting& counter) const;
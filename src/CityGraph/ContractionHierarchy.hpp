@@ -0,0 +1,120 @@
+/**
+ * ContractionHierarchy.hpp
+ * Author: Yuening YANG, Shenlang ZHOU
+ *
+ * This file declares the structure of ContractionHierarchy class, a
+ * preprocessed index over the roads of a CityGraph that answers shortest path
+ * queries by searching only toward more important cities.
+ */
+#ifndef CONTRACTIONHIERARCHY_HPP
+#define CONTRACTIONHIERARCHY_HPP
+
+#include <vector>
+
+#include "ArrayView.hpp"
+#include "SearchSpace.hpp"
+#include "SearchStats.hpp"
+
+using namespace std;
+
+class CityGraph;
+
+/**
+ * This class defines a contraction hierarchy of a city graph. Cities are
+ * contracted one by one from the least important, adding a shortcut road
+ * between 2 neighbors whenever the only shortest path between them went
+ * through the contracted city. A query then runs a bidirectional Dijkstra
+ * that only follows roads and shortcuts toward cities of higher rank.
+ */
+class ContractionHierarchy {
+  private:
+    int numCities;
+    ArrayView<int> rank;  // position of each city in the contraction order
+
+    /* upward graph: roads and shortcuts from each city to cities of higher
+     * rank. The arcs of city i are [firstArc[i], firstArc[i+1]) */
+    ArrayView<int> firstArc;
+    ArrayView<int> arcTarget;     // city of higher rank the arc leads to
+    ArrayView<double> arcWeight;  // length of the road or shortcut
+    ArrayView<int> arcMiddle;     // city bypassed by a shortcut, -1 for a road
+
+    /* append the cities on the road or shortcut from city to next to path,
+     * excluding city itself */
+    void unpackArc(int city, int next, vector<int>& path) const;
+
+    /* settle every city reachable upward from origin, putting their ids in
+     * reached and their distances in space */
+    void upwardSearch(int origin, SearchSpace& space,
+                      vector<int>& reached) const;
+
+  public:
+    /* Constructor of an empty ContractionHierarchy */
+    ContractionHierarchy(void);
+
+    /* contract all cities of the graph and build the upward graph */
+    void build(const CityGraph& graph);
+
+    /* find the shortest path from start to end, searching with the given
+     * forward and backward search state. The cities of the path are put in
+     * path, and its length is returned (-1 if there is no path) */
+    double query(int start, int end, vector<int>& path, SearchSpace& forward,
+                 SearchSpace& backward) const;
+
+    /* find the shortest path like query, counting the effort of the search
+     * with counter. Instantiated for NoCounting and Counting */
+    template <typename Counter>
+    double query(int start, int end, vector<int>& path, SearchSpace& forward,
+                 SearchSpace& backward, Counter& counter) const;
+
+    /**
+     * Compute the distance from every source to every target: the distance
+     * from sources[i] to targets[j] is put in table[i * targets.size() + j],
+     * or -1 if there is no path. The upward search of each target leaves its
+     * distances in buckets at the cities it settles, so the upward search of
+     * each source finds all targets by scanning the buckets of its cities.
+     * The searches are split among numThreads threads.
+     */
+    void distanceTable(const vector<int>& sources, const vector<int>& targets,
+                       vector<double>& table,
+                       unsigned int numThreads = 1) const;
+
+    /* return the contraction order and the upward graph, for the indexes
+     * derived from the hierarchy */
+    const ArrayView<int>& getRank() const { return rank; }
+    const ArrayView<int>& getFirstArc() const { return firstArc; }
+    const ArrayView<int>& getArcTarget() const { return arcTarget; }
+    const ArrayView<double>& getArcWeight() const { return arcWeight; }
+    const ArrayView<int>& getArcMiddle() const { return arcMiddle; }
+
+    /* use arrays stored elsewhere, laid out like those returned above, as
+     * the hierarchy of numCities cities with numArcs arcs. They must outlive
+     * the hierarchy */
+    void refer(int numCities, const int* rank, const int* firstArc,
+               size_t numArcs, const int* arcTarget, const double* arcWeight,
+               const int* arcMiddle);
+
+    /* return the number of cities in the hierarchy */
+    int getNumCities() const { return numCities; }
+
+    /* return the number of shortcuts added by the contraction */
+    int getNumShortcuts() const;
+
+    /**
+     * Save the hierarchy into a binary file, along with graphHash, the
+     * fingerprint of the graph it was built from.
+     *
+     * return true if file was written sucessfully, false otherwise
+     */
+    bool saveToFile(const char* filename,
+                    unsigned long long graphHash) const;
+
+    /**
+     * Load the hierarchy from a binary file written by saveToFile for a graph
+     * with the fingerprint graphHash.
+     *
+     * return true if file was loaded sucessfully, false otherwise
+     */
+    bool loadFromFile(const char* filename, unsigned long long graphHash);
+};
+
+#endif  // CONTRACTIONHIERARCHY_HPP
@@ -0,0 +1,384 @@
+/*
+ * CustomizableHierarchy.cpp
+ * Author: Yuening YANG, Shenlang ZHOU
+ *
+ * This file shows the implementation details of CustomizableHierarchy class
+ * methods, which are declared in 'CustomizableHierarchy.hpp' file.
+ */
+
+#include "CustomizableHierarchy.hpp"
+#include <stdint.h>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "CityGraph.hpp"
+
+using namespace std;
+
+const int DISSECTION_LEAF_SIZE = 16;   // regions this small are not split
+const int PARALLEL_LEVEL_SIZE = 256;   // smaller levels are not split
+const double NO_ROAD = INT32_MAX;      // weight of an arc without a road
+
+/* min-priority queue of (dist, rank) pairs */
+typedef priority_queue<pair<double, int>, vector<pair<double, int>>,
+                       greater<pair<double, int>>>
+    DistQueue;
+
+/* give the ranks [low, low + cities.size()) to cities by nested dissection.
+ * side must be 0 for all cities and is left so */
+static void dissect(const CityGraph& graph, vector<int>& cities, int low,
+                    vector<int>& side, vector<int>& cityOfRank) {
+    const ArrayView<int>& firstRoad = graph.getFirstRoad();
+    const ArrayView<int>& roadTarget = graph.getRoadTarget();
+
+    if (cities.size() <= DISSECTION_LEAF_SIZE) {
+        // cities with fewer roads first, so that fewer arcs are filled in
+        sort(cities.begin(), cities.end(), [&](int left, int right) {
+            int leftRoads = firstRoad[left + 1] - firstRoad[left];
+            int rightRoads = firstRoad[right + 1] - firstRoad[right];
+            return make_pair(leftRoads, left) < make_pair(rightRoads, right);
+        });
+        copy(cities.begin(), cities.end(), cityOfRank.begin() + low);
+        return;
+    }
+
+    // split the region at the median of its longer side
+    double minX = graph.getCityX(cities[0]), maxX = minX;
+    double minY = graph.getCityY(cities[0]), maxY = minY;
+    for (int city : cities) {
+        minX = min(minX, graph.getCityX(city));
+        maxX = max(maxX, graph.getCityX(city));
+        minY = min(minY, graph.getCityY(city));
+        maxY = max(maxY, graph.getCityY(city));
+    }
+    bool byX = maxX - minX >= maxY - minY;
+    auto coordinate = [&](int city) {
+        return make_pair(byX ? graph.getCityX(city) : graph.getCityY(city),
+                         city);
+    };
+    size_t half = cities.size() / 2;
+    nth_element(cities.begin(), cities.begin() + half, cities.end(),
+                [&](int left, int right) {
+                    return coordinate(left) < coordinate(right);
+                });
+    for (size_t i = 0; i < cities.size(); i++) {
+        side[cities[i]] = i < half ? 1 : 2;
+    }
+
+    // the separator is the smaller of the 2 sets of cities with a road into
+    // the other half
+    vector<int> borders[2];
+    for (int city : cities) {
+        for (int road = firstRoad[city]; road < firstRoad[city + 1]; road++) {
+            if (side[roadTarget[road]] == 3 - side[city]) {
+                borders[side[city] - 1].push_back(city);
+                break;
+            }
+        }
+    }
+    vector<int>& separator =
+        borders[0].size() <= borders[1].size() ? borders[0] : borders[1];
+    for (int city : separator) {
+        side[city] = 0;
+    }
+    vector<int> parts[2];
+    for (int city : cities) {
+        if (side[city] != 0) parts[side[city] - 1].push_back(city);
+        side[city] = 0;
+    }
+
+    // both halves first, then the separator above them
+    dissect(graph, parts[0], low, side, cityOfRank);
+    dissect(graph, parts[1], low + parts[0].size(), side, cityOfRank);
+    dissect(graph, separator, low + parts[0].size() + parts[1].size(), side,
+            cityOfRank);
+}
+
+/* Constructor of an empty CustomizableHierarchy */
+CustomizableHierarchy::CustomizableHierarchy(void)
+    : numCities(0), firstArc(1, 0), firstDown(1, 0), firstOfLevel(1, 0) {}
+
+/* order the cities by recursive bisection of their positions */
+void CustomizableHierarchy::orderCities(const CityGraph& graph) {
+    vector<int> cities(numCities);
+    for (int city = 0; city < numCities; city++) {
+        cities[city] = city;
+    }
+    vector<int> side(numCities, 0);
+    cityOfRank.assign(numCities, 0);
+    dissect(graph, cities, 0, side, cityOfRank);
+    rank.assign(numCities, 0);
+    for (int r = 0; r < numCities; r++) {
+        rank[cityOfRank[r]] = r;
+    }
+}
+
+/* order the cities of the graph and build the upward arcs */
+void CustomizableHierarchy::build(const CityGraph& graph) {
+    const ArrayView<int>& firstRoad = graph.getFirstRoad();
+    const ArrayView<int>& roadTarget = graph.getRoadTarget();
+    numCities = graph.getNumCities();
+    orderCities(graph);
+
+    // contracting a city connects all its higher neighbors. It is enough to
+    // give the others to the lowest of them, which is contracted next
+    vector<vector<int>> upward(numCities);
+    for (int u = 0; u < numCities; u++) {
+        int city = cityOfRank[u];
+        for (int road = firstRoad[city]; road < firstRoad[city + 1]; road++) {
+            if (rank[roadTarget[road]] > u) {
+                upward[u].push_back(rank[roadTarget[road]]);
+            }
+        }
+        sort(upward[u].begin(), upward[u].end());
+    }
+    for (int u = 0; u < numCities; u++) {
+        if (upward[u].empty()) continue;
+        int lowest = upward[u][0];
+        vector<int> merged;
+        set_union(upward[lowest].begin(), upward[lowest].end(),
+                  upward[u].begin() + 1, upward[u].end(),
+                  back_inserter(merged));
+        upward[lowest].swap(merged);
+    }
+
+    // lay out the upward arcs, and the road each one stands for
+    firstArc.assign(1, 0);
+    arcTarget.clear();
+    arcRoad.clear();
+    for (int u = 0; u < numCities; u++) {
+        for (int v : upward[u]) {
+            arcTarget.push_back(v);
+            arcRoad.push_back(graph.findRoad(cityOfRank[u], cityOfRank[v]));
+        }
+        firstArc.push_back(arcTarget.size());
+        vector<int>().swap(upward[u]);
+    }
+
+    // the same arcs seen from their higher end
+    firstDown.assign(numCities + 1, 0);
+    for (int v : arcTarget) {
+        firstDown[v + 1]++;
+    }
+    for (int u = 0; u < numCities; u++) {
+        firstDown[u + 1] += firstDown[u];
+    }
+    downArc.assign(arcTarget.size(), 0);
+    downSource.assign(arcTarget.size(), 0);
+    vector<int> nextSlot(firstDown.begin(), firstDown.end() - 1);
+    for (int u = 0; u < numCities; u++) {
+        for (int arc = firstArc[u]; arc < firstArc[u + 1]; arc++) {
+            downSource[nextSlot[arcTarget[arc]]] = u;
+            downArc[nextSlot[arcTarget[arc]]++] = arc;
+        }
+    }
+
+    // a rank is one level above the highest of its lower neighbors
+    vector<int> level(numCities, 0);
+    int numLevels = numCities > 0 ? 1 : 0;
+    for (int u = 0; u < numCities; u++) {
+        for (int arc = firstArc[u]; arc < firstArc[u + 1]; arc++) {
+            level[arcTarget[arc]] = max(level[arcTarget[arc]], level[u] + 1);
+            numLevels = max(numLevels, level[u] + 2);
+        }
+    }
+    firstOfLevel.assign(numLevels + 1, 0);
+    for (int u = 0; u < numCities; u++) {
+        firstOfLevel[level[u] + 1]++;
+    }
+    for (int l = 0; l < numLevels; l++) {
+        firstOfLevel[l + 1] += firstOfLevel[l];
+    }
+    levelRanks.assign(numCities, 0);
+    nextSlot.assign(firstOfLevel.begin(), firstOfLevel.end() - 1);
+    for (int u = 0; u < numCities; u++) {
+        levelRanks[nextSlot[level[u]]++] = u;
+    }
+
+    atomic_store(&metric, shared_ptr<const Metric>());
+}
+
+/* compute the final weights of the upward arcs of rank u in metric. The arcs
+ * of all lower neighbors must be final already */
+void CustomizableHierarchy::customizeRank(int u,
+                                          const vector<double>& roadWeights,
+                                          Metric& metric) const {
+    vector<double>& weight = metric.arcWeight;
+    vector<int>& middle = metric.arcMiddle;
+    for (int arc = firstArc[u]; arc < firstArc[u + 1]; arc++) {
+        weight[arc] = arcRoad[arc] == -1 ? NO_ROAD : roadWeights[arcRoad[arc]];
+        middle[arc] = -1;
+    }
+
+    // for every lower neighbor v and common higher neighbor w, the path
+    // u-v-w may be shorter than the arc u-w
+    for (int d = firstDown[u]; d < firstDown[u + 1]; d++) {
+        int down = downArc[d];
+        int v = downSource[d];
+        if (weight[down] >= NO_ROAD) continue;
+
+        // merge the arcs of v above u with the arcs of u
+        int i = upper_bound(arcTarget.begin() + firstArc[v],
+                            arcTarget.begin() + firstArc[v + 1], u) -
+                arcTarget.begin();
+        int j = firstArc[u];
+        while (i < firstArc[v + 1] && j < firstArc[u + 1]) {
+            if (arcTarget[i] < arcTarget[j]) {
+                i++;
+            } else if (arcTarget[j] < arcTarget[i]) {
+                j++;
+            } else {
+                if (weight[down] + weight[i] < weight[j]) {
+                    weight[j] = weight[down] + weight[i];
+                    middle[j] = v;
+                }
+                i++;
+                j++;
+            }
+        }
+    }
+}
+
+/* compute the arc weights for the given road weights and make it the current
+ * metric */
+void CustomizableHierarchy::customize(const vector<double>& roadWeights,
+                                      unsigned int numThreads) {
+    if (numThreads < 1) numThreads = 1;
+    shared_ptr<Metric> next = make_shared<Metric>();
+    next->arcWeight.assign(arcTarget.size(), NO_ROAD);
+    next->arcMiddle.assign(arcTarget.size(), -1);
+
+    for (size_t l = 0; l + 1 < firstOfLevel.size(); l++) {
+        int begin = firstOfLevel[l];
+        int end = firstOfLevel[l + 1];
+        if (numThreads == 1 || end - begin < PARALLEL_LEVEL_SIZE) {
+            for (int i = begin; i < end; i++) {
+                customizeRank(levelRanks[i], roadWeights, *next);
+            }
+            continue;
+        }
+
+        // the ranks of a level only write their own arcs
+        vector<thread> workers;
+        for (unsigned int t = 0; t < numThreads; t++) {
+            workers.emplace_back([&, t]() {
+                for (int i = begin + t; i < end; i += numThreads) {
+                    customizeRank(levelRanks[i], roadWeights, *next);
+                }
+            });
+        }
+        for (thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    // queries already running keep their own reference to the old metric
+    atomic_store(&metric, shared_ptr<const Metric>(next));
+}
+
+/* find the shortest path from start to end with the current metric */
+double CustomizableHierarchy::query(int start, int end, vector<int>& path,
+                                    SearchSpace& forward,
+                                    SearchSpace& backward) const {
+    path.clear();
+    shared_ptr<const Metric> current = atomic_load(&metric);
+    if (!current) return -1;
+    const vector<double>& weight = current->arcWeight;
+
+    // forward search from start and backward search from end, both upward
+    // in rank space
+    SearchSpace* spaces[2] = {&forward, &backward};
+    DistQueue toExplore[2];
+    int origins[2] = {rank[start], rank[end]};
+    for (int dir = 0; dir < 2; dir++) {
+        spaces[dir]->newQuery(numCities);
+        spaces[dir]->touch(origins[dir]);
+        spaces[dir]->dist[origins[dir]] = 0;
+        toExplore[dir].emplace(0, origins[dir]);
+    }
+
+    double best = NO_ROAD;
+    int meeting = -1;
+    while (!toExplore[0].empty() || !toExplore[1].empty()) {
+        for (int dir = 0; dir < 2; dir++) {
+            if (toExplore[dir].empty()) continue;
+            SearchSpace& space = *spaces[dir];
+            SearchSpace& other = *spaces[1 - dir];
+            double currentDist = toExplore[dir].top().first;
+            int current = toExplore[dir].top().second;
+            toExplore[dir].pop();
+            // a direction is done once it cannot improve the best path
+            if (currentDist >= best) {
+                toExplore[dir] = DistQueue();
+                continue;
+            }
+            if (currentDist > space.dist[current]) continue;
+
+            // check whether the other search already reached this rank
+            if (other.isReached(current) &&
+                currentDist + other.dist[current] < best) {
+                best = currentDist + other.dist[current];
+                meeting = current;
+            }
+
+            for (int arc = firstArc[current]; arc < firstArc[current + 1];
+                 arc++) {
+                if (weight[arc] >= NO_ROAD) continue;
+                int next = arcTarget[arc];
+                double distance = currentDist + weight[arc];
+                space.touch(next);
+                if (distance < space.dist[next]) {
+                    space.dist[next] = distance;
+                    space.prev[next] = current;
+                    toExplore[dir].emplace(distance, next);
+                }
+            }
+        }
+    }
+
+    if (meeting == -1) return -1;
+
+    // ranks from start up to the meeting rank, then down to end
+    vector<int> hierarchyPath;
+    for (int u = meeting; u != -1; u = forward.prev[u]) {
+        hierarchyPath.push_back(u);
+    }
+    reverse(hierarchyPath.begin(), hierarchyPath.end());
+    for (int u = backward.prev[meeting]; u != -1; u = backward.prev[u]) {
+        hierarchyPath.push_back(u);
+    }
+
+    // replace the shortcuts by the roads they stand for
+    vector<int> rankPath(1, origins[0]);
+    for (size_t i = 0; i + 1 < hierarchyPath.size(); i++) {
+        unpackArc(hierarchyPath[i], hierarchyPath[i + 1], *current, rankPath);
+    }
+    for (int u : rankPath) {
+        path.push_back(cityOfRank[u]);
+    }
+    return best;
+}
+
+/* append the ranks on the arc from rank u to rank v to path, excluding u
+ * itself */
+void CustomizableHierarchy::unpackArc(int u, int v, const Metric& metric,
+                                      vector<int>& path) const {
+    // the arc is stored with its lower end, sorted by target
+    int lower = min(u, v);
+    int higher = max(u, v);
+    int arc = lower_bound(arcTarget.begin() + firstArc[lower],
+                          arcTarget.begin() + firstArc[lower + 1], higher) -
+              arcTarget.begin();
+    int middle = metric.arcMiddle[arc];
+
+    if (middle == -1) {
+        path.push_back(v);
+    } else {
+        unpackArc(u, middle, metric, path);
+        unpackArc(middle, v, metric, path);
+    }
+}
@@ -0,0 +1,105 @@
+/**
+ * CustomizableHierarchy.hpp
+ * Author: Yuening YANG, Shenlang ZHOU
+ *
+ * This file declares the structure of CustomizableHierarchy class, a
+ * contraction hierarchy whose structure does not depend on the road lengths,
+ * so that new road weights can be applied quickly.
+ */
+#ifndef CUSTOMIZABLEHIERARCHY_HPP
+#define CUSTOMIZABLEHIERARCHY_HPP
+
+#include <memory>
+#include <vector>
+
+#include "SearchSpace.hpp"
+
+using namespace std;
+
+class CityGraph;
+
+/**
+ * This class defines a customizable contraction hierarchy. The expensive
+ * part only looks at the positions and roads of the cities: they are ordered
+ * by nested dissection (the separator between 2 halves of a region is
+ * contracted after both halves), and contracting them in that order without
+ * witness searches gives a fixed set of upward arcs. Customization then
+ * computes the weights of these arcs for a given weight of every road, level
+ * by level of the elimination so that a level is processed in parallel.
+ *
+ * Each customization produces a new Metric that replaces the current one
+ * atomically: queries that started on the old metric finish on it.
+ */
+class CustomizableHierarchy {
+  public:
+    /* weights of the upward arcs for one set of road weights */
+    struct Metric {
+        vector<double> arcWeight;  // length of the road or shortcut
+        vector<int> arcMiddle;  // rank of the city bypassed, -1 for a road
+    };
+
+  private:
+    int numCities;
+    vector<int> rank;        // position of each city in the contraction order
+    vector<int> cityOfRank;  // city at each position of the order
+
+    /* upward arcs of each city, in rank space: the arcs of rank i are
+     * [firstArc[i], firstArc[i+1]), sorted by target rank */
+    vector<int> firstArc;
+    vector<int> arcTarget;  // rank of the higher end of the arc
+    vector<int> arcRoad;    // road of the CityGraph it stands for, or -1
+
+    /* downward arcs: the arcs from lower ranks into rank i are
+     * downArc[firstDown[i]], ..., downArc[firstDown[i+1] - 1] */
+    vector<int> firstDown;
+    vector<int> downArc;
+    vector<int> downSource;  // lower rank each downward arc comes from
+
+    /* ranks grouped by elimination level: a rank only depends on lower
+     * levels, so the ranks of [firstOfLevel[l], firstOfLevel[l+1]) in
+     * levelRanks can be customized concurrently */
+    vector<int> firstOfLevel;
+    vector<int> levelRanks;
+
+    shared_ptr<const Metric> metric;  // current metric, swapped atomically
+
+    /* order the cities by recursive bisection of their positions */
+    void orderCities(const CityGraph& graph);
+
+    /* compute the final weights of the upward arcs of rank u in metric */
+    void customizeRank(int u, const vector<double>& roadWeights,
+                       Metric& metric) const;
+
+    /* append the ranks on the arc from rank u to rank v to path, excluding
+     * u itself */
+    void unpackArc(int u, int v, const Metric& metric,
+                   vector<int>& path) const;
+
+  public:
+    /* Constructor of an empty CustomizableHierarchy */
+    CustomizableHierarchy(void);
+
+    /* order the cities of the graph and build the upward arcs. Does not
+     * customize any metric */
+    void build(const CityGraph& graph);
+
+    /* compute the arc weights for the given weight of each road of the graph
+     * (indexed like CityGraph::getRoadTarget) with numThreads threads, then
+     * make it the current metric */
+    void customize(const vector<double>& roadWeights,
+                   unsigned int numThreads = 1);
+
+    /* find the shortest path from start to end with the current metric,
+     * searching with the given search state. The cities of the path are put
+     * in path, and its length is returned (-1 if there is no path) */
+    double query(int start, int end, vector<int>& path, SearchSpace& forward,
+                 SearchSpace& backward) const;
+
+    /* return whether a metric has been customized */
+    bool isCustomized() const { return (bool)atomic_load(&metric); }
+
+    /* return the number of arcs, roads and fill-in shortcuts */
+    int getNumArcs() const { return arcTarget.size(); }
+};
+
+#endif  // CUSTOMIZABLEHIERARCHY_HPP
@@ -0,0 +1,379 @@
+/*
+ * HubLabels.cpp
+ * Author: Yuening YANG, Shenlang ZHOU
+ *
+ * This file shows the implementation details of HubLabels class methods,
+ * which are declared in 'HubLabels.hpp' file.
+ */
+
+#include "HubLabels.hpp"
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <fstream>
+#include <vector>
+
+#include "ContractionHierarchy.hpp"
+
+using namespace std;
+
+const char HUB_FILE_MAGIC[8] = "HUBLBL2";  // header of label files
+const double NO_PATH = INT32_MAX;          // distance when there is no hub
+
+/* fixed-size header at the start of the buffer */
+struct HubLabelsHeader {
+    char magic[8];
+    uint64_t graphHash;  // fingerprint of the graph, set by saveToFile
+    uint64_t numCities;
+    uint64_t numEntries;
+    uint64_t numHubBytes;
+    uint64_t numArcs;
+};
+
+/* a label entry while the labels are being built */
+struct HubEntry {
+    uint32_t hub;   // rank of the hub
+    double dist;    // length of the upward path to the hub
+    uint32_t next;  // next city on that path
+};
+
+/* round a section size up to keep every section 8-byte aligned */
+static size_t aligned(size_t bytes) { return (bytes + 7) / 8 * 8; }
+
+/* append an array as a section of the buffer */
+template <typename T>
+static void appendSection(vector<char>& out, const vector<T>& array) {
+    size_t bytes = array.size() * sizeof(T);
+    const char* data = (const char*)array.data();
+    out.insert(out.end(), data, data + bytes);
+    out.resize(out.size() + aligned(bytes) - bytes, 0);
+}
+
+/* append a hub rank as a 7-bit group varint */
+static void writeVarint(vector<unsigned char>& out, uint32_t value) {
+    while (value >= 0x80) {
+        out.push_back((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    out.push_back(value);
+}
+
+/* read a varint written by writeVarint, advancing bytes past it */
+static inline uint32_t readVarint(const unsigned char*& bytes) {
+    uint32_t value = 0;
+    for (int shift = 0;; shift += 7) {
+        unsigned char byte = *bytes++;
+        value |= (uint32_t)(byte & 0x7f) << shift;
+        if (byte < 0x80) return value;
+    }
+}
+
+/* Constructor of an empty labeling */
+HubLabels::HubLabels(void)
+    : buffer(0), bufferSize(0), mapped(false), numCities(0), numArcs(0) {}
+
+/* build the labels from the upward search spaces of a contraction hierarchy
+ */
+void HubLabels::build(const ContractionHierarchy& hierarchy, bool prune) {
+    const ArrayView<int>& ranks = hierarchy.getRank();
+    const ArrayView<int>& firstArc = hierarchy.getFirstArc();
+    const ArrayView<int>& targets = hierarchy.getArcTarget();
+    const ArrayView<double>& weights = hierarchy.getArcWeight();
+    int n = hierarchy.getNumCities();
+    vector<int> cityOfRank(n);
+    for (int city = 0; city < n; city++) {
+        cityOfRank[ranks[city]] = city;
+    }
+
+    // the label of a city is built from the labels of its upward neighbors,
+    // which have higher ranks, so cities are labeled from the top down
+    vector<vector<HubEntry>> labels(n);
+    for (int r = n - 1; r >= 0; r--) {
+        int city = cityOfRank[r];
+        vector<HubEntry> candidates(1, HubEntry{(uint32_t)r, 0,
+                                                (uint32_t)city});
+        for (int arc = firstArc[city]; arc < firstArc[city + 1]; arc++) {
+            for (const HubEntry& entry : labels[targets[arc]]) {
+                candidates.push_back(HubEntry{entry.hub,
+                                              entry.dist + weights[arc],
+                                              (uint32_t)targets[arc]});
+            }
+        }
+
+        // keep the shortest entry of each hub
+        sort(candidates.begin(), candidates.end(),
+             [](const HubEntry& left, const HubEntry& right) {
+                 if (left.hub != right.hub) return left.hub < right.hub;
+                 return left.dist < right.dist;
+             });
+        vector<HubEntry>& label = labels[city];
+        for (const HubEntry& entry : candidates) {
+            if (label.empty() || label.back().hub != entry.hub) {
+                label.push_back(entry);
+            }
+        }
+        if (!prune) continue;
+
+        // drop a hub if another common hub gives a shorter path to it
+        vector<HubEntry> kept;
+        for (const HubEntry& entry : label) {
+            if (entry.hub == (uint32_t)r) {
+                kept.push_back(entry);
+                continue;
+            }
+            const vector<HubEntry>& hubLabel = labels[cityOfRank[entry.hub]];
+            double shortest = NO_PATH;
+            size_t i = 0, j = 0;
+            while (i < label.size() && j < hubLabel.size()) {
+                if (label[i].hub < hubLabel[j].hub) {
+                    i++;
+                } else if (hubLabel[j].hub < label[i].hub) {
+                    j++;
+                } else {
+                    shortest =
+                        min(shortest, label[i++].dist + hubLabel[j++].dist);
+                }
+            }
+            if (entry.dist <= shortest * (1 + 1e-12)) kept.push_back(entry);
+        }
+        label.swap(kept);
+    }
+
+    // lay out the labels in the buffer format
+    vector<uint64_t> firstEntries(1, 0);
+    vector<uint64_t> firstBytes(1, 0);
+    vector<double> dists;
+    vector<uint32_t> nexts;
+    vector<unsigned char> bytes;
+    for (int city = 0; city < n; city++) {
+        uint32_t previous = 0;
+        for (const HubEntry& entry : labels[city]) {
+            writeVarint(bytes, entry.hub - previous);
+            previous = entry.hub;
+            dists.push_back(entry.dist);
+            nexts.push_back(entry.next);
+        }
+        firstEntries.push_back(dists.size());
+        firstBytes.push_back(bytes.size());
+        vector<HubEntry>().swap(labels[city]);
+    }
+    vector<uint32_t> rankArray(ranks.begin(), ranks.end());
+    vector<uint32_t> arcFirstArray(firstArc.begin(), firstArc.end());
+    vector<uint32_t> arcTargetArray(targets.begin(), targets.end());
+    vector<int32_t> arcMiddleArray(hierarchy.getArcMiddle().begin(),
+                                   hierarchy.getArcMiddle().end());
+
+    HubLabelsHeader header;
+    copy(HUB_FILE_MAGIC, HUB_FILE_MAGIC + sizeof(header.magic), header.magic);
+    header.graphHash = 0;
+    header.numCities = n;
+    header.numEntries = dists.size();
+    header.numHubBytes = bytes.size();
+    header.numArcs = targets.size();
+    vector<char> out((const char*)&header,
+                     (const char*)&header + sizeof(header));
+    appendSection(out, firstEntries);
+    appendSection(out, firstBytes);
+    appendSection(out, dists);
+    appendSection(out, nexts);
+    appendSection(out, bytes);
+    appendSection(out, rankArray);
+    appendSection(out, arcFirstArray);
+    appendSection(out, arcTargetArray);
+    appendSection(out, arcMiddleArray);
+
+    release();
+    buffer = new char[out.size()];
+    bufferSize = out.size();
+    copy(out.begin(), out.end(), buffer);
+    attach();
+}
+
+/* point the views into buffer, return false if it is inconsistent */
+bool HubLabels::attach() {
+    if (bufferSize < sizeof(HubLabelsHeader)) return false;
+    const HubLabelsHeader* header = (const HubLabelsHeader*)buffer;
+    if (!equal(header->magic, header->magic + sizeof(header->magic),
+               HUB_FILE_MAGIC)) {
+        return false;
+    }
+
+    // walk through the sections, checking they fit in the buffer
+    size_t offset = sizeof(HubLabelsHeader);
+    uint64_t n = header->numCities;
+    uint64_t numEntries = header->numEntries;
+    auto section = [&](size_t bytes) {
+        const char* start = buffer + offset;
+        offset += aligned(bytes);
+        return start;
+    };
+    firstEntry = (const uint64_t*)section((n + 1) * sizeof(uint64_t));
+    firstByte = (const uint64_t*)section((n + 1) * sizeof(uint64_t));
+    entryDist = (const double*)section(numEntries * sizeof(double));
+    entryNext = (const uint32_t*)section(numEntries * sizeof(uint32_t));
+    hubBytes = (const unsigned char*)section(header->numHubBytes);
+    rank = (const uint32_t*)section(n * sizeof(uint32_t));
+    arcFirst = (const uint32_t*)section((n + 1) * sizeof(uint32_t));
+    arcTarget = (const uint32_t*)section(header->numArcs * sizeof(uint32_t));
+    arcMiddle = (const int32_t*)section(header->numArcs * sizeof(int32_t));
+    if (offset != bufferSize || firstEntry[n] != numEntries ||
+        firstByte[n] != header->numHubBytes ||
+        arcFirst[n] != header->numArcs) {
+        numCities = 0;
+        return false;
+    }
+    numCities = n;
+    numArcs = header->numArcs;
+    return true;
+}
+
+/* free the buffer */
+void HubLabels::release() {
+    if (mapped) {
+        munmap(buffer, bufferSize);
+    } else {
+        delete[] buffer;
+    }
+    buffer = 0;
+    bufferSize = 0;
+    mapped = false;
+    numCities = 0;
+    numArcs = 0;
+}
+
+/* return the distance from start to end (-1 if there is no path), and put the
+ * cities of the path in path if it is not null */
+double HubLabels::query(int start, int end, vector<int>* path) const {
+    if (path) path->clear();
+
+    // merge the 2 labels, decoding the hubs on the way
+    uint64_t i = firstEntry[start], endI = firstEntry[start + 1];
+    uint64_t j = firstEntry[end], endJ = firstEntry[end + 1];
+    const unsigned char* bytesI = hubBytes + firstByte[start];
+    const unsigned char* bytesJ = hubBytes + firstByte[end];
+    uint32_t hubI = i < endI ? readVarint(bytesI) : 0;
+    uint32_t hubJ = j < endJ ? readVarint(bytesJ) : 0;
+    double best = NO_PATH;
+    uint32_t bestHub = 0;
+    while (i < endI && j < endJ) {
+        if (hubI < hubJ) {
+            if (++i < endI) hubI += readVarint(bytesI);
+        } else if (hubJ < hubI) {
+            if (++j < endJ) hubJ += readVarint(bytesJ);
+        } else {
+            if (entryDist[i] + entryDist[j] < best) {
+                best = entryDist[i] + entryDist[j];
+                bestHub = hubI;
+            }
+            if (++i < endI) hubI += readVarint(bytesI);
+            if (++j < endJ) hubJ += readVarint(bytesJ);
+        }
+    }
+    if (best == NO_PATH) return -1;
+
+    if (path) {
+        // up from start to the hub, then down from the hub to end
+        path->push_back(start);
+        walkToHub(start, bestHub, *path);
+        vector<int> downPath(1, end);
+        walkToHub(end, bestHub, downPath);
+        for (int k = (int)downPath.size() - 2; k >= 0; k--) {
+            path->push_back(downPath[k]);
+        }
+    }
+    return best;
+}
+
+/* return the entry of hub (a rank) in the label of city, or -1 */
+long long HubLabels::findEntry(int city, uint32_t hub) const {
+    const unsigned char* bytes = hubBytes + firstByte[city];
+    uint32_t current = 0;
+    for (uint64_t i = firstEntry[city]; i < firstEntry[city + 1]; i++) {
+        current += readVarint(bytes);
+        if (current == hub) return i;
+        if (current > hub) break;
+    }
+    return -1;
+}
+
+/* append the cities from city up to its hub (a rank) to path, excluding city
+ * itself */
+void HubLabels::walkToHub(int city, uint32_t hub, vector<int>& path) const {
+    // every entry was derived from the same hub in the label of its next
+    // city, so the walk always finds it
+    while (rank[city] != hub) {
+        long long entry = findEntry(city, hub);
+        if (entry == -1) return;
+        int next = entryNext[entry];
+        unpackArc(city, next, path);
+        city = next;
+    }
+}
+
+/* append the cities on the arc from city to next to path, excluding city
+ * itself */
+void HubLabels::unpackArc(int city, int next, vector<int>& path) const {
+    // the arc is stored with the endpoint of lower rank
+    int lower = rank[city] < rank[next] ? city : next;
+    int higher = lower == city ? next : city;
+    int middle = -1;
+    for (uint32_t arc = arcFirst[lower]; arc < arcFirst[lower + 1]; arc++) {
+        if (arcTarget[arc] == (uint32_t)higher) {
+            middle = arcMiddle[arc];
+            break;
+        }
+    }
+
+    if (middle == -1) {
+        path.push_back(next);
+    } else {
+        unpackArc(city, middle, path);
+        unpackArc(middle, next, path);
+    }
+}
+
+/* save the labels into a binary file, along with the graph fingerprint */
+bool HubLabels::saveToFile(const char* filename,
+                           unsigned long long graphHash) const {
+    if (bufferSize < sizeof(HubLabelsHeader)) return false;
+    HubLabelsHeader header = *(const HubLabelsHeader*)buffer;
+    header.graphHash = graphHash;
+    ofstream out(filename, ios::binary);
+    out.write((const char*)&header, sizeof(header));
+    out.write(buffer + sizeof(header), bufferSize - sizeof(header));
+    return (bool)out;
+}
+
+/* map the labels of a binary file written by saveToFile for the graph with
+ * the fingerprint graphHash into memory */
+bool HubLabels::loadFromFile(const char* filename,
+                             unsigned long long graphHash) {
+    release();
+    int fd = open(filename, O_RDONLY);
+    if (fd == -1) return false;
+    struct stat status;
+    if (fstat(fd, &status) == -1 || status.st_size == 0) {
+        close(fd);
+        return false;
+    }
+    void* data = mmap(0, status.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return false;
+
+    buffer = (char*)data;
+    bufferSize = status.st_size;
+    mapped = true;
+    // the labels must have been built for the graph they are loaded for
+    if (!attach() ||
+        ((const HubLabelsHeader*)buffer)->graphHash != graphHash) {
+        release();
+        return false;
+    }
+    return true;
+}
+
+/* Destructor of HubLabels */
+HubLabels::~HubLabels() { release(); }
@@ -0,0 +1,109 @@
+/**
+ * HubLabels.hpp
+ * Author: Yuening YANG, Shenlang ZHOU
+ *
+ * This file declares the structure of HubLabels class, a hub labeling of the
+ * cities of a CityGraph derived from its contraction hierarchy.
+ */
+#ifndef HUBLABELS_HPP
+#define HUBLABELS_HPP
+
+#include <stdint.h>
+#include <vector>
+
+using namespace std;
+
+class ContractionHierarchy;
+
+/**
+ * This class defines a hub labeling: every city stores the cities of its
+ * upward search space in a contraction hierarchy (its hubs) with their
+ * distances, so the distance between 2 cities is the smallest sum over their
+ * common hubs, found by merging 2 sorted lists. Each entry also stores the
+ * next city toward the hub, so the path can be followed hub by hub.
+ *
+ * The labels live in one buffer laid out exactly like the file they are
+ * saved to, so a saved labeling is used in place through mmap and shared by
+ * all the processes that load it. Hubs are stored by rank, delta-encoded in
+ * 7-bit groups, which usually takes a single byte.
+ */
+class HubLabels {
+  private:
+    char* buffer;        // the whole labeling, owned or mapped
+    size_t bufferSize;   // size of buffer in bytes
+    bool mapped;         // whether buffer is mapped from a file
+
+    /* views into buffer */
+    uint64_t numCities;
+    uint64_t numArcs;
+    const uint64_t* firstEntry;  // entries of city i: [firstEntry[i], ...)
+    const uint64_t* firstByte;   // hub bytes of city i: [firstByte[i], ...)
+    const double* entryDist;     // distance to the hub
+    const uint32_t* entryNext;   // next city toward the hub
+    const unsigned char* hubBytes;  // delta-encoded hub ranks
+    const uint32_t* rank;           // rank of each city in the hierarchy
+    const uint32_t* arcFirst;       // upward graph of the hierarchy, to
+    const uint32_t* arcTarget;      // unpack the shortcuts of a path
+    const int32_t* arcMiddle;
+
+    /* free the buffer */
+    void release();
+
+    /* point the views into buffer, return false if it is inconsistent */
+    bool attach();
+
+    /* return the entry of hub (a rank) in the label of city, or -1 */
+    long long findEntry(int city, uint32_t hub) const;
+
+    /* append the cities on the arc from city to next to path, excluding
+     * city itself */
+    void unpackArc(int city, int next, vector<int>& path) const;
+
+    /* append the cities from city up to its hub (a rank) to path, excluding
+     * city itself */
+    void walkToHub(int city, uint32_t hub, vector<int>& path) const;
+
+  public:
+    /* Constructor of an empty labeling */
+    HubLabels(void);
+
+    /* build the labels from the upward search spaces of a contraction
+     * hierarchy. With prune, hubs whose distance is not the shortest (so
+     * never the best of a query) are dropped */
+    void build(const ContractionHierarchy& hierarchy, bool prune = true);
+
+    /* return the distance from start to end (-1 if there is no path), and
+     * put the cities of the path in path if it is not null */
+    double query(int start, int end, vector<int>* path = 0) const;
+
+    /* return the number of cities labeled */
+    int getNumCities() const { return numCities; }
+
+    /* return the total number of label entries */
+    long long getNumEntries() const {
+        return numCities ? firstEntry[numCities] : 0;
+    }
+
+    /**
+     * Save the labels into a binary file, along with graphHash, the
+     * fingerprint of the graph they were built from.
+     *
+     * return true if file was written sucessfully, false otherwise
+     */
+    bool saveToFile(const char* filename,
+                    unsigned long long graphHash) const;
+
+    /**
+     * Map the labels of a binary file written by saveToFile for a graph with
+     * the fingerprint graphHash into memory, read-only and shared with other
+     * processes mapping it.
+     *
+     * return true if file was loaded sucessfully, false otherwise
+     */
+    bool loadFromFile(const char* filename, unsigned long long graphHash);
+
+    /* Destructor of HubLabels */
+    ~HubLabels();
+};
+
+#endif  // HUBLABELS_HPP
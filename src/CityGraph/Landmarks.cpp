@@ -0,0 +1,225 @@
+/*
+ * Landmarks.cpp
+ * Author: Yuening YANG, Shenlang ZHOU
+ *
+ * This file shows the implementation details of Landmarks class methods,
+ * which are declared in 'Landmarks.hpp' file.
+ */
+
+#include "Landmarks.hpp"
+#include <math.h>
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <random>
+#include <vector>
+
+#include "CityGraph.hpp"
+
+using namespace std;
+
+const unsigned int AVOID_SEED = 2019;  // seed of the avoid strategy roots
+const int MAX_AVOID_ROOTS = 16;        // roots tried for an avoid landmark
+
+/* run Dijkstra from start over the roads of the graph, filling the distance
+ * (-1 if unreachable) and shortest path tree parent of every city */
+static void dijkstra(const CityGraph& graph, int start, vector<double>& dist,
+                     vector<int>& parents) {
+    const ArrayView<int>& firstRoad = graph.getFirstRoad();
+    const ArrayView<int>& roadTarget = graph.getRoadTarget();
+    const ArrayView<double>& roadLength = graph.getRoadLength();
+
+    dist.assign(graph.getNumCities(), -1);
+    parents.assign(graph.getNumCities(), -1);
+    vector<bool> settled(graph.getNumCities(), false);
+    priority_queue<pair<double, int>, vector<pair<double, int>>,
+                   greater<pair<double, int>>>
+        toExplore;
+    dist[start] = 0;
+    toExplore.emplace(0, start);
+    while (!toExplore.empty()) {
+        int current = toExplore.top().second;
+        toExplore.pop();
+        if (settled[current]) continue;
+        settled[current] = true;
+        for (int road = firstRoad[current]; road < firstRoad[current + 1];
+             road++) {
+            int next = roadTarget[road];
+            double distance = dist[current] + roadLength[road];
+            if (dist[next] == -1 || distance < dist[next]) {
+                dist[next] = distance;
+                parents[next] = current;
+                toExplore.emplace(distance, next);
+            }
+        }
+    }
+}
+
+/* Constructor of an empty set of landmarks */
+Landmarks::Landmarks(void)
+    : numCities(0), numRequested(0), strategy(FARTHEST) {}
+
+/* choose numLandmarks landmarks with the given strategy and precompute their
+ * distances to all cities */
+void Landmarks::build(const CityGraph& graph, int numLandmarks,
+                      Strategy strategy) {
+    numCities = graph.getNumCities();
+    numRequested = numLandmarks;
+    this->strategy = strategy;
+    landmarks.clear();
+    distances.clear();
+    if (numCities == 0 || numLandmarks < 1) return;
+    numLandmarks = min(numLandmarks, numCities);
+
+    // the first landmark is the city farthest from an arbitrary city
+    vector<double> dist;
+    vector<int> parents;
+    dijkstra(graph, 0, dist, parents);
+    addLandmark(graph, max_element(dist.begin(), dist.end()) - dist.begin());
+
+    mt19937 generator(AVOID_SEED);
+    while ((int)landmarks.size() < numLandmarks) {
+        int next = -1;
+        if (strategy == AVOID) {
+            // a root whose bounds are all exact gives no landmark, so draw
+            // another one, then fall back to the farthest city
+            for (int i = 0; i < MAX_AVOID_ROOTS && next == -1; i++) {
+                next = chooseAvoid(graph, generator() % numCities);
+            }
+        }
+        if (next == -1) next = chooseFarthest();
+        // stop if no new landmark can be found
+        if (next == -1 ||
+            find(landmarks.begin(), landmarks.end(), next) != landmarks.end()) {
+            break;
+        }
+        addLandmark(graph, next);
+    }
+}
+
+/* add a landmark and store its distances to all cities */
+void Landmarks::addLandmark(const CityGraph& graph, int city) {
+    vector<double> dist;
+    vector<int> parents;
+    dijkstra(graph, city, dist, parents);
+
+    // interleave the new distances after those of the previous landmarks
+    int count = landmarks.size();
+    vector<double> merged(numCities * (count + 1));
+    for (int i = 0; i < numCities; i++) {
+        copy(distances.begin() + i * count, distances.begin() + (i + 1) * count,
+             merged.begin() + i * (count + 1));
+        merged[i * (count + 1) + count] = dist[i];
+    }
+    distances.own(move(merged));
+    vector<int> chosen(landmarks.begin(), landmarks.end());
+    chosen.push_back(city);
+    landmarks.own(move(chosen));
+}
+
+/* use arrays stored elsewhere as the landmarks of a graph */
+void Landmarks::refer(int numCities, const int* landmarks, int numLandmarks,
+                      const double* distances, int numRequested,
+                      Strategy strategy) {
+    this->numCities = numCities;
+    this->numRequested = numRequested;
+    this->strategy = strategy;
+    this->landmarks.refer(landmarks, numLandmarks);
+    this->distances.refer(distances, (size_t)numCities * numLandmarks);
+}
+
+/* choose the next landmark with the farthest strategy */
+int Landmarks::chooseFarthest() const {
+    // cities no landmark can reach come first, so every component gets a
+    // landmark
+    int next = -1;
+    double farthest = -1;
+    size_t count = landmarks.size();
+    for (int city = 0; city < numCities; city++) {
+        double nearest = INFINITY;
+        for (size_t i = 0; i < count; i++) {
+            double d = distances[city * count + i];
+            if (d != -1) nearest = min(nearest, d);
+        }
+        if (nearest > farthest) {
+            farthest = nearest;
+            next = city;
+        }
+    }
+    return next;
+}
+
+/* choose the next landmark with the avoid strategy */
+int Landmarks::chooseAvoid(const CityGraph& graph, int root) const {
+    vector<double> dist;
+    vector<int> parents;
+    dijkstra(graph, root, dist, parents);
+
+    // visit the tree from the leaves up, i.e. by decreasing distance
+    vector<int> order;
+    for (int city = 0; city < numCities; city++) {
+        if (dist[city] != -1) order.push_back(city);
+    }
+    sort(order.begin(), order.end(),
+         [&](int left, int right) { return dist[left] > dist[right]; });
+
+    // the size of a subtree is the total error of its bounds, or 0 if it
+    // already contains a landmark
+    vector<double> size(numCities, 0);
+    vector<bool> hasLandmark(numCities, false);
+    for (int city : landmarks) {
+        hasLandmark[city] = true;
+    }
+    for (int city : order) {
+        if (hasLandmark[city]) {
+            size[city] = 0;
+        } else {
+            size[city] +=
+                dist[city] - lowerBound(city, root, landmarks.size());
+        }
+        if (parents[city] != -1) {
+            if (hasLandmark[city]) hasLandmark[parents[city]] = true;
+            size[parents[city]] += size[city];
+        }
+    }
+
+    // descend into the heaviest subtree down to a leaf
+    vector<vector<int>> children(numCities);
+    for (int city : order) {
+        if (parents[city] != -1) children[parents[city]].push_back(city);
+    }
+    if (size[root] == 0) return -1;
+    int city = root;
+    while (true) {
+        int heaviest = -1;
+        for (int child : children[city]) {
+            if (size[child] > 0 &&
+                (heaviest == -1 || size[child] > size[heaviest])) {
+                heaviest = child;
+            }
+        }
+        if (heaviest == -1) return city;
+        city = heaviest;
+    }
+}
+
+/* return a lower bound of the distance from city to target */
+double Landmarks::lowerBound(int city, int target) const {
+    return lowerBound(city, target, landmarks.size());
+}
+
+/* return a lower bound of the distance from city to target using only the
+ * first count landmarks */
+double Landmarks::lowerBound(int city, int target, int count) const {
+    int numLandmarks = landmarks.size();
+    if (numLandmarks == 0) return 0;
+    const double* fromCity = &distances[city * numLandmarks];
+    const double* fromTarget = &distances[target * numLandmarks];
+    double bound = 0;
+    for (int i = 0; i < count; i++) {
+        // landmarks in another component give no bound
+        if (fromCity[i] == -1 || fromTarget[i] == -1) continue;
+        bound = max(bound, fabs(fromTarget[i] - fromCity[i]));
+    }
+    return bound;
+}
@@ -0,0 +1,94 @@
+/**
+ * Landmarks.hpp
+ * Author: Yuening YANG, Shenlang ZHOU
+ *
+ * This file declares the structure of Landmarks class, which precomputes the
+ * distances from a few landmark cities to give A* (ALT) lower bounds.
+ */
+#ifndef LANDMARKS_HPP
+#define LANDMARKS_HPP
+
+#include <vector>
+
+#include "ArrayView.hpp"
+
+using namespace std;
+
+class CityGraph;
+
+/**
+ * This class defines a set of landmark cities together with the shortest
+ * distance from every landmark to every city. By the triangle inequality,
+ * |dist(L, target) - dist(L, city)| is a lower bound of dist(city, target)
+ * for every landmark L, which is much tighter than the straight-line distance
+ * when roads detour around obstacles.
+ */
+class Landmarks {
+  public:
+    /* strategies to choose the landmarks */
+    enum Strategy {
+        FARTHEST,  // each landmark is the city farthest from the previous ones
+        AVOID      // each landmark covers the region the bounds serve worst
+    };
+
+  private:
+    int numCities;
+    int numRequested;          // landmarks asked of build
+    Strategy strategy;         // how build chose them
+    ArrayView<int> landmarks;  // ids of the landmark cities
+
+    /* dist from landmark i to city j is at distances[j * numLandmarks + i]
+     * (-1 if unreachable), so the bounds of a city are read contiguously */
+    ArrayView<double> distances;
+
+    /* add a landmark and store its distances to all cities */
+    void addLandmark(const CityGraph& graph, int city);
+
+    /* return a lower bound of the distance from city to target using only
+     * the first count landmarks */
+    double lowerBound(int city, int target, int count) const;
+
+    /* choose the next landmark with the avoid strategy: grow a shortest path
+     * tree from root, weigh every city by how much its bound underestimates
+     * its distance to root, and descend into the heaviest subtree without a
+     * landmark down to a leaf. return -1 if the bounds are already exact
+     * for every city reached from root */
+    int chooseAvoid(const CityGraph& graph, int root) const;
+
+    /* choose the next landmark with the farthest strategy: the city farthest
+     * from all landmarks, cities no landmark can reach first */
+    int chooseFarthest() const;
+
+  public:
+    /* Constructor of an empty set of landmarks */
+    Landmarks(void);
+
+    /* choose numLandmarks landmarks with the given strategy and precompute
+     * their distances to all cities. Fewer are chosen if no new landmark can
+     * be found, and none if numLandmarks is below 1 */
+    void build(const CityGraph& graph, int numLandmarks, Strategy strategy);
+
+    /* return a lower bound of the distance from city to target */
+    double lowerBound(int city, int target) const;
+
+    /* return the ids of the landmark cities */
+    const ArrayView<int>& getLandmarks() const { return landmarks; }
+
+    /* return the distances from the landmarks, laid out as described above */
+    const ArrayView<double>& getDistances() const { return distances; }
+
+    /* return the number of landmarks asked of build */
+    int getNumRequested() const { return numRequested; }
+
+    /* return the strategy build chose the landmarks with */
+    Strategy getStrategy() const { return strategy; }
+
+    /* use arrays stored elsewhere, laid out like those returned above, as
+     * the landmarks of a graph of numCities cities, chosen by build asked
+     * for numRequested landmarks with strategy. The arrays must outlive the
+     * landmarks */
+    void refer(int numCities, const int* landmarks, int numLandmarks,
+               const double* distances, int numRequested, Strategy strategy);
+};
+
+#endif  // LANDMARKS_HPP
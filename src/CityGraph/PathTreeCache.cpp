@@ -0,0 +1,78 @@
+/*
+ * PathTreeCache.cpp
+ * Author: Yuening YANG, Shenlang ZHOU
+ *
+ * This file shows the implementation details of PathTreeCache class methods,
+ * which are declared in 'PathTreeCache.hpp' file.
+ */
+
+#include "PathTreeCache.hpp"
+#include <algorithm>
+#include "CityGraph.hpp"
+
+using namespace std;
+
+/* Constructor of an empty cache of at most capacity trees */
+PathTreeCache::PathTreeCache(int capacity) : capacity(max(capacity, 1)) {}
+
+/* find the shortest path from source to target in the graph with the tree of
+ * source, grown until target is settled */
+void PathTreeCache::findPath(const CityGraph& graph, int source, int target,
+                             vector<int>& path) {
+    path.clear();
+    auto found = treeOf.find(source);
+    if (found != treeOf.end()) {
+        // most recently used first
+        trees.splice(trees.begin(), trees, found->second);
+    } else {
+        // reuse the search state of the least recently used tree, if full
+        if ((int)trees.size() < capacity) {
+            trees.emplace_front();
+        } else {
+            treeOf.erase(trees.back().source);
+            trees.splice(trees.begin(), trees, prev(trees.end()));
+        }
+        Tree& tree = trees.front();
+        tree.source = source;
+        tree.space.newQuery(graph.getNumCities());
+        tree.space.touch(source);
+        tree.space.dist[source] = 0;
+        tree.toExplore = decltype(tree.toExplore)();
+        tree.toExplore.emplace(0, source);
+        treeOf[source] = trees.begin();
+    }
+
+    // go on with Dijkstra where the previous target left it
+    Tree& tree = trees.front();
+    SearchSpace& space = tree.space;
+    const ArrayView<int>& firstRoad = graph.getFirstRoad();
+    const ArrayView<int>& roadTarget = graph.getRoadTarget();
+    const ArrayView<double>& roadLength = graph.getRoadLength();
+    while (!space.isSettled(target) && !tree.toExplore.empty()) {
+        double currentDist = tree.toExplore.top().first;
+        int current = tree.toExplore.top().second;
+        tree.toExplore.pop();
+        if (space.isSettled(current)) continue;
+        space.settle(current);
+
+        for (int road = firstRoad[current]; road < firstRoad[current + 1];
+             road++) {
+            int next = roadTarget[road];
+            if (space.isSettled(next)) continue;
+            space.touch(next);
+            double distance = currentDist + roadLength[road];
+            if (distance < space.dist[next]) {
+                space.dist[next] = distance;
+                space.prev[next] = current;
+                tree.toExplore.emplace(distance, next);
+            }
+        }
+    }
+    if (!space.isSettled(target)) return;
+
+    // walk up the tree from target
+    for (int city = target; city != -1; city = space.prev[city]) {
+        path.push_back(city);
+    }
+    reverse(path.begin(), path.end());
+}
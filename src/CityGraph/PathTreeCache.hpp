@@ -0,0 +1,65 @@
+/**
+ * PathTreeCache.hpp
+ * Author: Yuening YANG, Shenlang ZHOU
+ *
+ * This file declares the structure of PathTreeCache class, which keeps the
+ * shortest path trees of the sources routed most recently.
+ */
+#ifndef PATHTREECACHE_HPP
+#define PATHTREECACHE_HPP
+
+#include <functional>
+#include <list>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+#include "SearchSpace.hpp"
+
+using namespace std;
+
+class CityGraph;
+
+/**
+ * This class defines a least recently used cache of shortest path trees,
+ * keyed by their source city. A tree is grown by Dijkstra only until the
+ * target asked is settled, and keeps its frontier to grow further for the
+ * next target, so the paths from one source to many targets take a single
+ * search, each path then being a walk up the tree. Each tree holds a search
+ * state as large as the graph.
+ */
+class PathTreeCache {
+  private:
+    /* a shortest path tree grown from source as far as needed so far */
+    struct Tree {
+        int source;
+        SearchSpace space;
+        priority_queue<pair<double, int>, vector<pair<double, int>>,
+                       greater<pair<double, int>>>
+            toExplore;  // frontier of the tree
+    };
+
+    int capacity;      // most trees kept
+    list<Tree> trees;  // trees by most recent use first
+    unordered_map<int, list<Tree>::iterator> treeOf;  // source -> its tree
+
+  public:
+    /* Constructor of an empty cache of at most capacity trees */
+    explicit PathTreeCache(int capacity = 4);
+
+    /* trees refer to their position in the list, so caches are not copied */
+    PathTreeCache(const PathTreeCache&) = delete;
+    PathTreeCache& operator=(const PathTreeCache&) = delete;
+
+    /* return whether the tree of source is in the cache */
+    bool contains(int source) const { return treeOf.count(source); }
+
+    /* find the shortest path from source to target in the graph with the
+     * tree of source, grown until target is settled. A new tree replaces the
+     * least recently used one if the cache is full. The cities of the path
+     * are put in path (empty if there is no path) */
+    void findPath(const CityGraph& graph, int source, int target,
+                  vector<int>& path);
+};
+
+#endif  // PATHTREECACHE_HPP
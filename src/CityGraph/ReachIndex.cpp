@@ -0,0 +1,236 @@
+/*
+ * ReachIndex.cpp
+ * Author: Yuening YANG, Shenlang ZHOU
+ *
+ * This file shows the implementation details of ReachIndex class methods,
+ * which are declared in 'ReachIndex.hpp' file.
+ */
+
+#include "ReachIndex.hpp"
+#include <math.h>
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "CityGraph.hpp"
+#include "SearchSpace.hpp"
+
+using namespace std;
+
+const double EPSILON_GROWTH = 3;  // threshold of a round over the previous
+const int MAX_TREE_CITIES = 2000;  // expected tree size that ends the rounds
+const double TIGHT_TOLERANCE = 1e-9;  // rounding of sums of road lengths
+
+/* the state of one thread growing partial trees */
+struct TreeState {
+    SearchSpace space;
+    vector<int> settled;   // cities in the order they were settled
+    vector<int> position;  // index of a settled city in settled
+    vector<double> height;  // penalized height of a settled city
+};
+
+/* grow the partial tree of source over the cities not removed, expanding
+ * only the cities closer than radius, and raise bound[v] to the reach v has
+ * in the tree: the smaller of its penalized depth and its penalized height.
+ * Heights follow every tight road, not only the tree roads, so a shortest
+ * path tied with the tree path still counts */
+static void growPartialTree(const CityGraph& graph, int source, double radius,
+                            const vector<bool>& removed,
+                            const vector<double>& penalty, TreeState& state,
+                            vector<double>& bound) {
+    const ArrayView<int>& firstRoad = graph.getFirstRoad();
+    const ArrayView<int>& roadTarget = graph.getRoadTarget();
+    const ArrayView<double>& roadLength = graph.getRoadLength();
+    SearchSpace& space = state.space;
+
+    space.newQuery(graph.getNumCities());
+    space.touch(source);
+    space.dist[source] = 0;
+    state.settled.clear();
+    priority_queue<pair<double, int>, vector<pair<double, int>>,
+                   greater<pair<double, int>>>
+        toExplore;
+    toExplore.emplace(0, source);
+    while (!toExplore.empty()) {
+        int current = toExplore.top().second;
+        toExplore.pop();
+        if (space.isSettled(current)) continue;
+        space.settle(current);
+        state.position[current] = state.settled.size();
+        state.settled.push_back(current);
+        // cities beyond the radius are leaves of the partial tree
+        if (current != source && space.dist[current] >= radius) continue;
+        for (int road = firstRoad[current]; road < firstRoad[current + 1];
+             road++) {
+            int next = roadTarget[road];
+            if (removed[next] || space.isSettled(next)) continue;
+            space.touch(next);
+            double distance = space.dist[current] + roadLength[road];
+            if (distance < space.dist[next]) {
+                space.dist[next] = distance;
+                toExplore.emplace(distance, next);
+            }
+        }
+    }
+
+    // the height of a city is the longest tight path down from it, plus the
+    // penalty of the city it ends at. Children settle after their parents,
+    // except across empty roads, which need the heights propagated again
+    for (int city : state.settled) {
+        state.height[city] = penalty[city];
+    }
+    bool propagate = true;
+    while (propagate) {
+        bool changed = false;
+        bool backward = false;
+        for (int i = state.settled.size() - 1; i >= 0; i--) {
+            int city = state.settled[i];
+            for (int road = firstRoad[city]; road < firstRoad[city + 1];
+                 road++) {
+                int next = roadTarget[road];
+                if (removed[next] || !space.isSettled(next)) continue;
+                double distance = space.dist[city] + roadLength[road];
+                if (fabs(distance - space.dist[next]) >
+                    TIGHT_TOLERANCE * space.dist[next]) {
+                    continue;
+                }
+                if (state.position[next] < i) backward = true;
+                double height = roadLength[road] + state.height[next];
+                if (height > state.height[city]) {
+                    state.height[city] = height;
+                    changed = true;
+                }
+            }
+        }
+        propagate = backward && changed;
+    }
+
+    for (int city : state.settled) {
+        double depth = penalty[source] + space.dist[city];
+        bound[city] = max(bound[city], min(depth, state.height[city]));
+    }
+}
+
+/* compute upper bounds of the reach of every city in rounds of partial
+ * trees with a growing threshold */
+void ReachIndex::build(const CityGraph& graph, unsigned int numThreads) {
+    const ArrayView<int>& firstRoad = graph.getFirstRoad();
+    const ArrayView<int>& roadTarget = graph.getRoadTarget();
+    const ArrayView<double>& roadLength = graph.getRoadLength();
+    int numCities = graph.getNumCities();
+    if (numThreads < 1) numThreads = 1;
+    reaches.assign(numCities, 0);
+    if (numCities == 0) return;
+
+    // the first threshold is the mean road length
+    double epsilon = 1;
+    if (roadLength.size() > 0) {
+        double total = 0;
+        for (double length : roadLength) {
+            total += length;
+        }
+        epsilon = max(total / roadLength.size(), 1e-9);
+    }
+    double previousEpsilon = 0;
+
+    vector<int> remaining(numCities);
+    for (int city = 0; city < numCities; city++) {
+        remaining[city] = city;
+    }
+    vector<bool> removed(numCities, false);
+    vector<double> penalty(numCities, 0);
+    vector<TreeState> states(numThreads);
+    for (TreeState& state : states) {
+        state.position.resize(numCities);
+        state.height.resize(numCities);
+    }
+    // each thread keeps the largest reach its own trees give, and the number
+    // of cities its trees settled
+    vector<vector<double>> threadBounds(numThreads,
+                                        vector<double>(numCities, 0));
+    vector<size_t> threadSettled(numThreads);
+    double meanTree = 0;
+
+    while (!remaining.empty()) {
+        // the trees grow with the square of the threshold. Once they would
+        // cover too many cities, the cities left keep an infinite bound,
+        // which never prunes them but keeps the build time in check
+        double nextTree = min(meanTree * EPSILON_GROWTH * EPSILON_GROWTH,
+                              (double)remaining.size());
+        if (nextTree > MAX_TREE_CITIES) {
+            for (int city : remaining) {
+                reaches[city] = INFINITY;
+            }
+            return;
+        }
+
+        vector<thread> workers;
+        for (unsigned int t = 0; t < numThreads; t++) {
+            workers.emplace_back([&, t]() {
+                vector<double>& bound = threadBounds[t];
+                for (int city : remaining) {
+                    bound[city] = 0;
+                }
+                threadSettled[t] = 0;
+                for (size_t i = t; i < remaining.size(); i += numThreads) {
+                    int source = remaining[i];
+                    // the inner cities of a path of reach epsilon are within
+                    // 2 epsilon of the city after source
+                    double longestRoad = 0;
+                    for (int road = firstRoad[source];
+                         road < firstRoad[source + 1]; road++) {
+                        if (!removed[roadTarget[road]]) {
+                            longestRoad = max(longestRoad, roadLength[road]);
+                        }
+                    }
+                    growPartialTree(graph, source, 2 * epsilon + longestRoad,
+                                    removed, penalty, states[t], bound);
+                    threadSettled[t] += states[t].settled.size();
+                }
+            });
+        }
+        size_t settled = 0;
+        for (unsigned int t = 0; t < numThreads; t++) {
+            workers[t].join();
+            settled += threadSettled[t];
+        }
+        meanTree = (double)settled / remaining.size();
+
+        // a city whose trees all give less than epsilon has reach below
+        // epsilon, and its trees give its reach unless it is below the
+        // previous epsilon
+        vector<int> bounded;
+        vector<int> next;
+        for (int city : remaining) {
+            double bound = 0;
+            for (const vector<double>& threadBound : threadBounds) {
+                bound = max(bound, threadBound[city]);
+            }
+            if (bound < epsilon) {
+                reaches[city] = max(bound, previousEpsilon);
+                removed[city] = true;
+                bounded.push_back(city);
+            } else {
+                next.push_back(city);
+            }
+        }
+
+        // the paths the remaining cities lose through a bounded city are at
+        // most its reach plus the road to it
+        for (int city : bounded) {
+            for (int road = firstRoad[city]; road < firstRoad[city + 1];
+                 road++) {
+                int neighbor = roadTarget[road];
+                if (!removed[neighbor]) {
+                    penalty[neighbor] = max(penalty[neighbor],
+                                            reaches[city] + roadLength[road]);
+                }
+            }
+        }
+        remaining.swap(next);
+        previousEpsilon = epsilon;
+        epsilon *= EPSILON_GROWTH;
+    }
+}
@@ -0,0 +1,51 @@
+/**
+ * ReachIndex.hpp
+ * Author: Yuening YANG, Shenlang ZHOU
+ *
+ * This file declares the structure of ReachIndex class, which precomputes the
+ * reach of every city of a CityGraph to prune A* searches.
+ */
+#ifndef REACHINDEX_HPP
+#define REACHINDEX_HPP
+
+#include <vector>
+
+using namespace std;
+
+class CityGraph;
+
+/**
+ * This class defines the reach of every city: the largest min(dist(s, v),
+ * dist(v, t)) over the shortest paths s-t through city v. A city v with
+ * reach smaller than both its distance from the start and a lower bound of
+ * its distance to the target cannot be on the shortest path, so a search can
+ * skip it. Cities with high reach are the ones long trips go through. The
+ * index keeps upper bounds of the reaches, which prune less but as safely.
+ */
+class ReachIndex {
+  private:
+    vector<double> reaches;  // reach of each city
+
+  public:
+    /* compute upper bounds of the reach of every city in rounds of a growing
+     * threshold. Each round grows a partial shortest path tree from every
+     * city left, bounds the cities whose reach is below the threshold, and
+     * removes them, charging their reach to their neighbors. The cities left
+     * once the trees would grow too big keep an infinite bound. The trees of
+     * a round are split among numThreads threads */
+    void build(const CityGraph& graph, unsigned int numThreads = 1);
+
+    /* return whether city can be skipped by a search that reached it at dist
+     * from the start, with lowerBound a lower bound of its distance to the
+     * target */
+    bool prune(int city, double dist, double lowerBound) const {
+        // tolerate the rounding of sums of road lengths
+        double reach = reaches[city] * (1 + 1e-9);
+        return reach < dist && reach < lowerBound;
+    }
+
+    /* return the reach of the city with the given id */
+    double getReach(int city) const { return reaches[city]; }
+};
+
+#endif  // REACHINDEX_HPP
@@ -0,0 +1,80 @@
+/**
+ * SearchSpace.hpp
+ * Author: Yuening YANG, Shenlang ZHOU
+ *
+ * This file declares the SearchSpace class, the per-city state of a shortest
+ * path search on a CityGraph.
+ */
+#ifndef SEARCHSPACE_HPP
+#define SEARCHSPACE_HPP
+
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+
+using namespace std;
+
+/**
+ * This class holds the search state of each city, reused by every query. The
+ * state of a city is only valid if its stamp equals the stamp of the current
+ * query, so a query only initializes the cities it touches.
+ */
+class SearchSpace {
+  public:
+    vector<double> dist;       // dist from the start city
+    vector<double> heuristic;  // heuristic function value of the city
+    vector<int> prev;          // previous city in the path
+
+  private:
+    vector<unsigned int> reachedStamp;  // query that last touched the city
+    vector<unsigned int> settledStamp;  // query that last settled the city
+    unsigned int queryStamp;            // stamp of the current query
+
+  public:
+    /* Constructor of an empty SearchSpace */
+    SearchSpace(void) : queryStamp(0) {}
+
+    /* start a new query on a graph of numCities cities, invalidating the
+     * search state of all cities */
+    void newQuery(int numCities) {
+        if ((int)dist.size() != numCities) {
+            dist.resize(numCities);
+            heuristic.resize(numCities);
+            prev.resize(numCities);
+            reachedStamp.assign(numCities, 0);
+            settledStamp.assign(numCities, 0);
+        }
+        queryStamp++;
+        if (queryStamp == 0) {
+            // the stamp wrapped around, old stamps could look current again
+            fill(reachedStamp.begin(), reachedStamp.end(), 0);
+            fill(settledStamp.begin(), settledStamp.end(), 0);
+            queryStamp = 1;
+        }
+    }
+
+    /* initialize the state of city for the current query, if not yet done.
+     * return true if it was not reached before */
+    bool touch(int city) {
+        if (reachedStamp[city] == queryStamp) return false;
+        reachedStamp[city] = queryStamp;
+        dist[city] = INT32_MAX;
+        prev[city] = -1;
+        return true;
+    }
+
+    /* mark city as settled in the current query */
+    void settle(int city) { settledStamp[city] = queryStamp; }
+
+    /* return whether city was reached in the current query */
+    bool isReached(int city) const {
+        return reachedStamp[city] == queryStamp;
+    }
+
+    /* return whether city was settled in the current query */
+    bool isSettled(int city) const {
+        return settledStamp[city] == queryStamp;
+    }
+};
+
+#endif  // SEARCHSPACE_HPP
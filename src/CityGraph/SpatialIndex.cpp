@@ -0,0 +1,149 @@
+/*
+ * SpatialIndex.cpp
+ * Author: Yuening YANG, Shenlang ZHOU
+ *
+ * This file shows the implementation details of SpatialIndex class methods,
+ * which are declared in 'SpatialIndex.hpp' file.
+ */
+
+#include "SpatialIndex.hpp"
+#include <algorithm>
+#include <vector>
+
+using namespace std;
+
+const int LEAF_SIZE = 8;  // subtrees this small are scanned linearly
+
+/* build the index of the numPoints points (xs[i], ys[i]) with id i */
+void SpatialIndex::build(const double* xs, const double* ys, int numPoints) {
+    // arrange the ids while the coordinates are still indexed by id
+    this->xs.assign(xs, xs + numPoints);
+    this->ys.assign(ys, ys + numPoints);
+    ids.resize(numPoints);
+    for (size_t i = 0; i < ids.size(); i++) {
+        ids[i] = i;
+    }
+    build(0, ids.size(), 0);
+
+    // then store the coordinates in tree order too
+    for (size_t i = 0; i < ids.size(); i++) {
+        this->xs[i] = xs[ids[i]];
+        this->ys[i] = ys[ids[i]];
+    }
+}
+
+/* arrange the points of [begin, end) into a subtree split on axis */
+void SpatialIndex::build(int begin, int end, int axis) {
+    if (end - begin <= LEAF_SIZE) return;
+
+    // move the median on the axis to the middle, smaller points before it
+    int middle = begin + (end - begin) / 2;
+    const vector<double>& keys = axis == 0 ? xs : ys;
+    nth_element(ids.begin() + begin, ids.begin() + middle, ids.begin() + end,
+                [&](int left, int right) { return keys[left] < keys[right]; });
+
+    build(begin, middle, 1 - axis);
+    build(middle + 1, end, 1 - axis);
+}
+
+/* put the ids of the k points closest to (x, y) in result, nearest first */
+void SpatialIndex::nearest(double x, double y, int k,
+                           vector<int>& result) const {
+    result.clear();
+    if (k <= 0) return;
+    vector<pair<double, int>> nearest;
+    nearest.reserve(k + 1);
+    findNearest(0, ids.size(), 0, x, y, k, nearest);
+    sort_heap(nearest.begin(), nearest.end());
+    for (const pair<double, int>& point : nearest) {
+        result.push_back(point.second);
+    }
+}
+
+/* look for closer points in the subtree [begin, end) split on axis */
+void SpatialIndex::findNearest(int begin, int end, int axis, double x,
+                               double y, int k,
+                               vector<pair<double, int>>& nearest) const {
+    // keep a point if it beats the worst of the k best so far
+    auto consider = [&](int i) {
+        pair<double, int> point((xs[i] - x) * (xs[i] - x) +
+                                    (ys[i] - y) * (ys[i] - y),
+                                ids[i]);
+        if ((int)nearest.size() < k) {
+            nearest.push_back(point);
+            push_heap(nearest.begin(), nearest.end());
+        } else if (point < nearest.front()) {
+            pop_heap(nearest.begin(), nearest.end());
+            nearest.back() = point;
+            push_heap(nearest.begin(), nearest.end());
+        }
+    };
+
+    if (end - begin <= LEAF_SIZE) {
+        for (int i = begin; i < end; i++) {
+            consider(i);
+        }
+        return;
+    }
+
+    int middle = begin + (end - begin) / 2;
+    consider(middle);
+    double offset = axis == 0 ? x - xs[middle] : y - ys[middle];
+
+    // search the side of the query point first, then the other side only if
+    // the splitting line is closer than the worst of the k best
+    if (offset < 0) {
+        findNearest(begin, middle, 1 - axis, x, y, k, nearest);
+        if ((int)nearest.size() < k ||
+            offset * offset <= nearest.front().first) {
+            findNearest(middle + 1, end, 1 - axis, x, y, k, nearest);
+        }
+    } else {
+        findNearest(middle + 1, end, 1 - axis, x, y, k, nearest);
+        if ((int)nearest.size() < k ||
+            offset * offset <= nearest.front().first) {
+            findNearest(begin, middle, 1 - axis, x, y, k, nearest);
+        }
+    }
+}
+
+/* put the ids of the points inside the box in result, in increasing order */
+void SpatialIndex::inBox(double minX, double minY, double maxX, double maxY,
+                         vector<int>& result) const {
+    result.clear();
+    findInBox(0, ids.size(), 0, minX, minY, maxX, maxY, result);
+    sort(result.begin(), result.end());
+}
+
+/* put the ids of the points of the subtree [begin, end) inside the box in
+ * result */
+void SpatialIndex::findInBox(int begin, int end, int axis, double minX,
+                             double minY, double maxX, double maxY,
+                             vector<int>& result) const {
+    auto consider = [&](int i) {
+        if (xs[i] >= minX && xs[i] <= maxX && ys[i] >= minY && ys[i] <= maxY) {
+            result.push_back(ids[i]);
+        }
+    };
+
+    if (end - begin <= LEAF_SIZE) {
+        for (int i = begin; i < end; i++) {
+            consider(i);
+        }
+        return;
+    }
+
+    int middle = begin + (end - begin) / 2;
+    consider(middle);
+    double split = axis == 0 ? xs[middle] : ys[middle];
+    double low = axis == 0 ? minX : minY;
+    double high = axis == 0 ? maxX : maxY;
+    // points before the middle are not larger on the axis, points after it
+    // are not smaller
+    if (low <= split) {
+        findInBox(begin, middle, 1 - axis, minX, minY, maxX, maxY, result);
+    }
+    if (high >= split) {
+        findInBox(middle + 1, end, 1 - axis, minX, minY, maxX, maxY, result);
+    }
+}
@@ -0,0 +1,58 @@
+/**
+ * SpatialIndex.hpp
+ * Author: Yuening YANG, Shenlang ZHOU
+ *
+ * This file declares the structure of SpatialIndex class, a k-d tree over the
+ * positions of the cities of a CityGraph.
+ */
+#ifndef SPATIALINDEX_HPP
+#define SPATIALINDEX_HPP
+
+#include <vector>
+
+using namespace std;
+
+/**
+ * This class defines an implicit k-d tree over a set of points. The points
+ * are reordered so that every subtree is a contiguous range whose middle
+ * point splits the rest alternately by x and by y, so the tree needs no
+ * pointers and a lookup reads neighboring memory.
+ */
+class SpatialIndex {
+  private:
+    /* the points in tree order (in id order while building) */
+    vector<double> xs;
+    vector<double> ys;
+    vector<int> ids;  // id of each point
+
+    /* arrange the points of [begin, end) into a subtree split on axis */
+    void build(int begin, int end, int axis);
+
+    /* look for closer points in the subtree [begin, end) split on axis.
+     * nearest is a max-heap of the k best (squared distance, id) pairs */
+    void findNearest(int begin, int end, int axis, double x, double y,
+                     int k, vector<pair<double, int>>& nearest) const;
+
+    /* put the ids of the points of the subtree [begin, end) inside the box
+     * in result */
+    void findInBox(int begin, int end, int axis, double minX, double minY,
+                   double maxX, double maxY, vector<int>& result) const;
+
+  public:
+    /* build the index of the numPoints points (xs[i], ys[i]) with id i */
+    void build(const double* xs, const double* ys, int numPoints);
+
+    /* put the ids of the k points closest to (x, y) in result, nearest
+     * first. Ties are broken by the lower id */
+    void nearest(double x, double y, int k, vector<int>& result) const;
+
+    /* put the ids of the points with minX <= x <= maxX and minY <= y <= maxY
+     * in result, in increasing order */
+    void inBox(double minX, double minY, double maxX, double maxY,
+               vector<int>& result) const;
+
+    /* return the number of points in the index */
+    int size() const { return ids.size(); }
+};
+
+#endif  // SPATIALINDEX_HPP
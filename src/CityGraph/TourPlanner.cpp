@@ -0,0 +1,209 @@
+/*
+ * TourPlanner.cpp
+ * Author: Yuening YANG, Shenlang ZHOU
+ *
+ * This file shows the implementation details of TourPlanner class methods,
+ * which are declared in 'TourPlanner.hpp' file.
+ */
+
+#include "TourPlanner.hpp"
+#include <math.h>
+#include <algorithm>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+const double MIN_GAIN = 1e-9;         // smallest improvement of a move
+const int MAX_SEGMENT = 3;            // longest segment moved by Or-opt
+const unsigned int TOUR_SEED = 2019;  // seed of the perturbed restarts
+
+/* Constructor of a planner over numStops stops */
+TourPlanner::TourPlanner(const vector<double>& table, int numStops)
+    : numStops(numStops), table(table) {}
+
+/* build a tour by nearest insertion starting from the given stop */
+void TourPlanner::nearestInsertion(int first, vector<int>& tour) const {
+    tour.assign(1, first);
+    vector<bool> inTour(numStops, false);
+    vector<double> closest(numStops);  // distance of each stop to the tour
+    inTour[first] = true;
+    for (int stop = 0; stop < numStops; stop++) {
+        closest[stop] = dist(first, stop);
+    }
+
+    for (int step = 1; step < numStops; step++) {
+        // the stop closest to the tour
+        int next = -1;
+        for (int stop = 0; stop < numStops; stop++) {
+            if (inTour[stop]) continue;
+            if (next == -1 || closest[stop] < closest[next]) next = stop;
+        }
+
+        // goes between the 2 consecutive stops it lengthens the tour least
+        int position = 0;
+        double leastIncrease = INFINITY;
+        for (size_t i = 0; i < tour.size(); i++) {
+            int from = tour[i];
+            int to = tour[(i + 1) % tour.size()];
+            double increase =
+                dist(from, next) + dist(next, to) - dist(from, to);
+            if (increase < leastIncrease) {
+                leastIncrease = increase;
+                position = i + 1;
+            }
+        }
+        tour.insert(tour.begin() + position, next);
+
+        inTour[next] = true;
+        for (int stop = 0; stop < numStops; stop++) {
+            closest[stop] = min(closest[stop], dist(next, stop));
+        }
+    }
+}
+
+/* apply improving 2-opt moves to tour until there are none left */
+bool TourPlanner::twoOpt(vector<int>& tour) const {
+    int n = tour.size();
+    bool changed = false;
+    bool improved = true;
+    while (improved) {
+        improved = false;
+        for (int i = 0; i + 2 < n; i++) {
+            for (int j = i + 2; j < n; j++) {
+                // the edges (a, b) and (c, d) become (a, c) and (b, d)
+                if (i == 0 && j == n - 1) continue;
+                int a = tour[i];
+                int b = tour[i + 1];
+                int c = tour[j];
+                int d = tour[(j + 1) % n];
+                double delta =
+                    dist(a, c) + dist(b, d) - dist(a, b) - dist(c, d);
+                if (delta < -MIN_GAIN) {
+                    reverse(tour.begin() + i + 1, tour.begin() + j + 1);
+                    improved = true;
+                    changed = true;
+                }
+            }
+        }
+    }
+    return changed;
+}
+
+/* apply improving Or-opt moves to tour until there are none left */
+bool TourPlanner::orOpt(vector<int>& tour) const {
+    int n = tour.size();
+    bool changed = false;
+    bool improved = true;
+    while (improved) {
+        improved = false;
+        for (int length = 1; length <= MAX_SEGMENT; length++) {
+            // the rest of the tour needs an edge not touching the segment
+            if (n - length < 3) break;
+            for (int i = 0; i + length <= n; i++) {
+                int first = tour[i];
+                int last = tour[i + length - 1];
+                int before = tour[(i + n - 1) % n];
+                int after = tour[(i + length) % n];
+                double removed = dist(before, first) + dist(last, after) -
+                                 dist(before, after);
+
+                // the edge (p, q) where the segment fits best, either way
+                for (int j = 0; j < n; j++) {
+                    if ((j - i + 1 + n) % n <= length) continue;
+                    int p = tour[j];
+                    int q = tour[(j + 1) % n];
+                    double forward = dist(p, first) + dist(last, q);
+                    double backward = dist(p, last) + dist(first, q);
+                    double added = min(forward, backward) - dist(p, q);
+                    if (added - removed >= -MIN_GAIN) continue;
+
+                    vector<int> segment(tour.begin() + i,
+                                        tour.begin() + i + length);
+                    if (backward < forward) {
+                        reverse(segment.begin(), segment.end());
+                    }
+                    tour.erase(tour.begin() + i, tour.begin() + i + length);
+                    auto position = find(tour.begin(), tour.end(), p) + 1;
+                    tour.insert(position, segment.begin(), segment.end());
+                    improved = true;
+                    changed = true;
+                    break;
+                }
+            }
+        }
+    }
+    return changed;
+}
+
+/* return the length of the closed tour */
+double TourPlanner::tourLength(const vector<int>& tour) const {
+    double length = 0;
+    for (size_t i = 0; i < tour.size(); i++) {
+        length += dist(tour[i], tour[(i + 1) % tour.size()]);
+    }
+    return length;
+}
+
+/* put a short closed tour visiting every stop once in tour, starting at stop
+ * 0, trying numRestarts starts with numThreads threads */
+double TourPlanner::plan(vector<int>& tour, int numRestarts,
+                         unsigned int numThreads) const {
+    tour.clear();
+    if (numStops == 0) return 0;
+    if (numRestarts < 1) numRestarts = 1;
+    if (numThreads < 1) numThreads = 1;
+
+    // restart r inserts from stop r, and once every stop has been a first
+    // stop, perturbs that tour by a random double bridge: with cuts at
+    // 0 < a < b < c < n, A B C D becomes A C B D
+    vector<vector<int>> tours(numRestarts);
+    vector<double> lengths(numRestarts);
+    vector<thread> workers;
+    for (unsigned int t = 0; t < numThreads; t++) {
+        workers.emplace_back([&, t]() {
+            for (int r = t; r < numRestarts; r += numThreads) {
+                vector<int>& current = tours[r];
+                nearestInsertion(r % numStops, current);
+                if (r >= numStops && numStops >= 8) {
+                    mt19937 generator(TOUR_SEED + r);
+                    int cuts[3];
+                    do {
+                        for (int& cut : cuts) {
+                            cut = 1 + generator() % (numStops - 1);
+                        }
+                        sort(cuts, cuts + 3);
+                    } while (cuts[0] == cuts[1] || cuts[1] == cuts[2]);
+                    auto begin = current.begin();
+                    vector<int> perturbed(begin, begin + cuts[0]);
+                    perturbed.insert(perturbed.end(), begin + cuts[1],
+                                     begin + cuts[2]);
+                    perturbed.insert(perturbed.end(), begin + cuts[0],
+                                     begin + cuts[1]);
+                    perturbed.insert(perturbed.end(), begin + cuts[2],
+                                     current.end());
+                    current.swap(perturbed);
+                }
+                bool changed = true;
+                while (changed) {
+                    changed = twoOpt(current);
+                    changed = orOpt(current) || changed;
+                }
+                lengths[r] = tourLength(current);
+            }
+        });
+    }
+    for (thread& worker : workers) {
+        worker.join();
+    }
+
+    // the shortest tour, the earliest restart on ties, from stop 0
+    int best = 0;
+    for (int r = 1; r < numRestarts; r++) {
+        if (lengths[r] < lengths[best]) best = r;
+    }
+    tour = tours[best];
+    rotate(tour.begin(), find(tour.begin(), tour.end(), 0), tour.end());
+    return lengths[best];
+}
@@ -0,0 +1,58 @@
+/**
+ * TourPlanner.hpp
+ * Author: Yuening YANG, Shenlang ZHOU
+ *
+ * This file declares the structure of TourPlanner class, which finds a short
+ * closed tour through a set of stops from their distance table.
+ */
+#ifndef TOURPLANNER_HPP
+#define TOURPLANNER_HPP
+
+#include <vector>
+
+using namespace std;
+
+/**
+ * This class defines a heuristic for the symmetric traveling salesman
+ * problem. A tour is built by nearest insertion: the stop closest to the
+ * tour is inserted where it lengthens the tour the least. It is then
+ * improved by 2-opt (reversing a part of the tour) and Or-opt (moving 1 to 3
+ * consecutive stops elsewhere) until neither helps. Restarts from other
+ * first stops, and from random perturbations of these, are spread over
+ * threads, and the shortest tour wins.
+ */
+class TourPlanner {
+  private:
+    int numStops;
+    const vector<double>& table;  // dist from stop i to j at [i * n + j]
+
+    /* return the distance between 2 stops */
+    double dist(int from, int to) const { return table[from * numStops + to]; }
+
+    /* build a tour by nearest insertion starting from the given stop */
+    void nearestInsertion(int first, vector<int>& tour) const;
+
+    /* apply improving 2-opt moves to tour until there are none left.
+     * return true if the tour changed */
+    bool twoOpt(vector<int>& tour) const;
+
+    /* apply improving Or-opt moves to tour until there are none left.
+     * return true if the tour changed */
+    bool orOpt(vector<int>& tour) const;
+
+    /* return the length of the closed tour */
+    double tourLength(const vector<int>& tour) const;
+
+  public:
+    /* Constructor of a planner over numStops stops whose distance table is
+     * table, which must outlive the planner */
+    TourPlanner(const vector<double>& table, int numStops);
+
+    /* put a short closed tour visiting every stop once in tour, starting at
+     * stop 0, trying numRestarts starts with numThreads threads. return its
+     * length */
+    double plan(vector<int>& tour, int numRestarts = 16,
+                unsigned int numThreads = 1) const;
+};
+
+#endif  // TOURPLANNER_HPP
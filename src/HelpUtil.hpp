@@ -7,17 +7,25 @@
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 #include "ActorGraph.hpp"
 #include "CityGraph.hpp"
+#include "SearchStats.hpp"
 
 using namespace std;
 
 class HelpUtil {
   public:
-    /* find the shortest path of the graph. used in pathfinder.cpp */
+    /* find the shortest path of the graph, and write the effort of each
+     * search to statsFile if given. used in pathfinder.cpp */
     void static find_graph_paths(ActorGraph* graph, istream& inFile,
-                                 ostream& outFile, bool use_weighted_edges) {
+                                 ostream& outFile, bool use_weighted_edges,
+                                 ostream* statsFile = 0) {
+        vector<string> labels;
+        vector<SearchStats> stats;
         // write header
         outFile << "(actor)--[movie#@year]-->(actor)--..." << endl;
 
@@ -51,17 +59,70 @@ class HelpUtil {
             }
 
             // write path
+            if (!statsFile) {
+                graph->find_path(targets[0], targets[1], outFile,
+                                 use_weighted_edges);
+                continue;
+            }
+            stats.emplace_back();
             graph->find_path(targets[0], targets[1], outFile,
-                             use_weighted_edges);
+                             use_weighted_edges, stats.back());
+            labels.push_back(targets[0] + " -> " + targets[1]);
+        }
+        if (statsFile) write_stats(labels, stats, *statsFile);
+    }
+
+    /* estimate the weighted distance of each actor pair from the landmark
+     * distances only. used in pathfinder.cpp */
+    void static estimate_graph_distances(ActorGraph* graph, istream& inFile,
+                                         ostream& outFile) {
+        // write header
+        outFile << "lower_bound\tupper_bound" << endl;
+
+        bool have_header = false;
+
+        while (inFile) {
+            string s;
+
+            // get the next line
+            if (!getline(inFile, s)) break;
+
+            if (!have_header) {
+                // skip the header
+                have_header = true;
+                continue;
+            }
+
+            istringstream ss(s);
+            vector<string> targets;
+
+            while (ss) {
+                string str;
+
+                if (!getline(ss, str, '\t')) break;
+                targets.push_back(str);
+            }
+
+            if (targets.size() != 2) {
+                // we should have exactly 2 columns
+                continue;
+            }
+
+            // write estimate
+            graph->estimate_distance(targets[0], targets[1], outFile);
         }
     }
 
     /* find the 4 actors with the highest priority who have collaberated and not
      * collaberated with the the given actor, and output to outFile1 and
-     * outFile2 respectively */
+     * outFile2 respectively, and write the effort of each search to statsFile
+     * if given */
     void static predictFutureCollaboration(ActorGraph* graph, istream& inFile,
                                            ostream& outFile1,
-                                           ostream& outFile2) {
+                                           ostream& outFile2,
+                                           ostream* statsFile = 0) {
+        vector<string> labels;
+        vector<SearchStats> stats;
         // write header
         outFile1 << "Actor1,Actor2,Actor3,Actor4" << endl;
         outFile2 << "Actor1,Actor2,Actor3,Actor4" << endl;
@@ -80,13 +141,55 @@ class HelpUtil {
             }
 
             // predict link and write output
-            graph->predictlink(s, outFile1, outFile2);
+            if (!statsFile) {
+                graph->predictlink(s, outFile1, outFile2);
+                continue;
+            }
+            stats.emplace_back();
+            graph->predictlink(s, outFile1, outFile2, stats.back());
+            labels.push_back(s);
+        }
+        if (statsFile) write_stats(labels, stats, *statsFile);
+    }
+
+    /* write the search effort of each query as a tab-separated row headed by
+     * its label, then their total. used with the --stats options */
+    void static write_stats(const vector<string>& labels,
+                            const vector<SearchStats>& stats,
+                            ostream& outFile) {
+        outFile << "query\t";
+        SearchStats::printHeader(outFile);
+        outFile << '\n';
+        SearchStats total;
+        for (size_t i = 0; i < stats.size(); i++) {
+            outFile << labels[i] << '\t';
+            stats[i].print(outFile);
+            outFile << '\n';
+            total += stats[i];
         }
+        outFile << "total of " << stats.size() << " queries\t";
+        total.print(outFile);
+        outFile << endl;
     }
 
-    /* find the shortest path of the graph */
+    /* find the shortest path of the graph. The queries are read in batches
+     * and each batch is searched by numThreads threads, each with its own
+     * search state; the paths are still written in query order. With a
+     * statsFile, the effort of each search is written to it */
     void static find_AStar_paths(CityGraph* graph, istream& inFile,
-                                 ostream& outFile) {
+                                 ostream& outFile, unsigned int numThreads = 1,
+                                 ostream* statsFile = 0) {
+        const int BATCH_SIZE = 65536;  // queries held in memory at once
+        if (numThreads < 1) numThreads = 1;
+        vector<pair<int, int>> queries;
+        vector<string> outputs;
+        vector<string> labels;
+        vector<SearchStats> stats;
+        vector<SearchStats> batchStats;
+        vector<SearchStats>* statsOut = statsFile ? &batchStats : 0;
+        vector<PathTreeCache> caches(numThreads);
+        graph->prepareEngine();
+
         while (inFile) {
             string s;
 
@@ -108,8 +211,305 @@ class HelpUtil {
                 continue;
             }
 
-            // write path
-            graph->find_path(targets[0], targets[1], outFile);
+            // unknown cities give the empty path of start == end
+            int start = graph->getCityId(targets[0]);
+            int end = graph->getCityId(targets[1]);
+            if (start == -1 || end == -1) start = end = 0;
+            queries.emplace_back(start, end);
+            if (statsFile) labels.push_back(targets[0] + " -> " + targets[1]);
+            if (queries.size() == BATCH_SIZE) {
+                find_path_batch(graph, queries, outputs, numThreads, caches,
+                                statsOut);
+                for (const string& output : outputs) outFile << output;
+                stats.insert(stats.end(), batchStats.begin(), batchStats.end());
+                queries.clear();
+            }
+        }
+
+        if (!queries.empty()) {
+            find_path_batch(graph, queries, outputs, numThreads, caches,
+                            statsOut);
+            for (const string& output : outputs) outFile << output;
+            stats.insert(stats.end(), batchStats.begin(), batchStats.end());
+        }
+        if (statsFile) write_stats(labels, stats, *statsFile);
+    }
+
+    /* find the shortest path of each query "x1 y1 x2 y2", from the city
+     * nearest to (x1, y1) to the city nearest to (x2, y2). used in
+     * navigationsystem.cpp */
+    void static find_coordinate_paths(CityGraph* graph, istream& inFile,
+                                      ostream& outFile,
+                                      unsigned int numThreads = 1) {
+        const int BATCH_SIZE = 65536;  // queries held in memory at once
+        if (numThreads < 1) numThreads = 1;
+        vector<pair<int, int>> queries;
+        vector<string> outputs;
+        vector<PathTreeCache> caches(numThreads);
+        graph->prepareEngine();
+
+        string s;
+        while (getline(inFile, s)) {
+            istringstream ss(s);
+            double x1, y1, x2, y2;
+            if (!(ss >> x1 >> y1 >> x2 >> y2)) continue;
+
+            // an empty graph gives the empty path of start == end
+            int start = graph->findNearestCity(x1, y1);
+            int end = graph->findNearestCity(x2, y2);
+            if (start == -1 || end == -1) start = end = 0;
+            queries.emplace_back(start, end);
+            if (queries.size() == BATCH_SIZE) {
+                find_path_batch(graph, queries, outputs, numThreads, caches);
+                for (const string& output : outputs) outFile << output;
+                queries.clear();
+            }
+        }
+
+        if (!queries.empty()) {
+            find_path_batch(graph, queries, outputs, numThreads, caches);
+            for (const string& output : outputs) outFile << output;
+        }
+    }
+
+    /* find the shortest path and up to numAlternatives alternatives of each
+     * query, printed tab-separated on one line. The queries are read in
+     * batches and each batch is searched by numThreads threads. used in
+     * navigationsystem.cpp */
+    void static find_alternative_paths(CityGraph* graph, istream& inFile,
+                                       ostream& outFile, int numAlternatives,
+                                       unsigned int numThreads = 1) {
+        const int BATCH_SIZE = 65536;  // queries held in memory at once
+        if (numThreads < 1) numThreads = 1;
+        vector<pair<int, int>> queries;
+        vector<string> outputs;
+        graph->prepareEngine();
+
+        // search a batch and write its paths in query order
+        auto flush = [&]() {
+            outputs.assign(queries.size(), "");
+            vector<thread> workers;
+            for (unsigned int t = 0; t < numThreads; t++) {
+                workers.emplace_back([&, t]() {
+                    SearchSpace forward;
+                    SearchSpace backward;
+                    vector<vector<int>> paths;
+                    for (size_t q = t; q < queries.size(); q += numThreads) {
+                        graph->findAlternatives(
+                            queries[q].first, queries[q].second,
+                            numAlternatives, paths, forward, backward);
+                        ostringstream out;
+                        graph->printPaths(paths, out);
+                        outputs[q] = out.str();
+                    }
+                });
+            }
+            for (thread& worker : workers) {
+                worker.join();
+            }
+            for (const string& output : outputs) outFile << output;
+            queries.clear();
+        };
+
+        string s;
+        while (getline(inFile, s)) {
+            istringstream ss(s);
+            vector<string> targets;
+            string str;
+            while (getline(ss, str, ' ')) targets.push_back(str);
+
+            if (targets.size() != 2) {
+                // we should have exactly 2 columns
+                continue;
+            }
+
+            // unknown cities give no path, like start == end
+            int start = graph->getCityId(targets[0]);
+            int end = graph->getCityId(targets[1]);
+            if (start == -1 || end == -1) start = end = 0;
+            queries.emplace_back(start, end);
+            if (queries.size() == BATCH_SIZE) flush();
+        }
+        if (!queries.empty()) flush();
+    }
+
+    /* find a short closed tour through the cities of each line, separated
+     * by spaces, and print its route, or an empty line if there is none.
+     * used in navigationsystem.cpp */
+    void static find_tours(CityGraph* graph, istream& inFile,
+                           ostream& outFile, unsigned int numThreads = 1) {
+        string s;
+        while (getline(inFile, s)) {
+            istringstream ss(s);
+            vector<string> stops;
+            string str;
+            while (getline(ss, str, ' ')) {
+                if (!str.empty()) stops.push_back(str);
+            }
+            if (stops.empty()) continue;
+
+            vector<int> route;
+            graph->findTour(stops, route, numThreads);
+            graph->printPath(route, outFile);
+        }
+    }
+
+    /* find the paths of a batch of city id pairs with numThreads threads and
+     * put the printed path of query i in outputs[i]. The queries of a source
+     * all go to the same thread, and when the engine allows it, a source
+     * with many targets in the batch gets its paths from one shortest path
+     * tree, reused from caches[t] if thread t still has it. The choice
+     * depends on the batch alone, since trees and searches may break ties
+     * differently, so the paths are the same for any numThreads. With
+     * stats, the effort of query i is put in (*stats)[i], and every query is
+     * searched on its own since trees share their effort */
+    void static find_path_batch(const CityGraph* graph,
+                                const vector<pair<int, int>>& queries,
+                                vector<string>& outputs,
+                                unsigned int numThreads,
+                                vector<PathTreeCache>& caches,
+                                vector<SearchStats>* stats = 0) {
+        const int MIN_TREE_TARGETS = 4;  // targets that pay for a tree
+        if (numThreads < 1) numThreads = 1;
+        outputs.assign(queries.size(), "");
+        if (stats) stats->assign(queries.size(), SearchStats());
+        unordered_map<int, int> numTargets;  // source -> queries in batch
+        if (graph->usesPathTrees() && !stats) {
+            for (const pair<int, int>& query : queries) {
+                numTargets[query.first]++;
+            }
+        }
+
+        vector<thread> workers;
+        for (unsigned int t = 0; t < numThreads; t++) {
+            workers.emplace_back([&, t]() {
+                SearchSpace forward;
+                SearchSpace backward;
+                vector<int> path;
+                for (size_t q = 0; q < queries.size(); q++) {
+                    int start = queries[q].first;
+                    int end = queries[q].second;
+                    if (start % numThreads != t) continue;
+                    if (stats) {
+                        graph->findPath(start, end, path, forward, backward,
+                                        (*stats)[q]);
+                    } else if (graph->usesPathTrees() &&
+                               numTargets.at(start) >= MIN_TREE_TARGETS) {
+                        graph->findTreePath(start, end, path, caches[t]);
+                    } else {
+                        graph->findPath(start, end, path, forward, backward);
+                    }
+                    ostringstream out;
+                    graph->printPath(path, out);
+                    outputs[q] = out.str();
+                }
+            });
+        }
+        for (thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    /* write the distance table from the source cities to the target cities,
+     * each listed one per line, as tab-separated rows. used in
+     * navigationsystem.cpp */
+    void static write_distance_table(CityGraph* graph, istream& sourceFile,
+                                     istream& targetFile, ostream& outFile,
+                                     unsigned int numThreads = 1) {
+        vector<string> sources;
+        vector<string> targets;
+        string s;
+        while (getline(sourceFile, s)) {
+            if (!s.empty()) sources.push_back(s);
+        }
+        while (getline(targetFile, s)) {
+            if (!s.empty()) targets.push_back(s);
+        }
+
+        vector<double> table;
+        graph->distanceTable(sources, targets, table, numThreads);
+
+        // header of target names, then one row per source
+        streamsize precision = outFile.precision(10);
+        outFile << "source";
+        for (const string& target : targets) {
+            outFile << '\t' << target;
+        }
+        outFile << '\n';
+        for (size_t i = 0; i < sources.size(); i++) {
+            outFile << sources[i];
+            for (size_t j = 0; j < targets.size(); j++) {
+                outFile << '\t' << table[i * targets.size() + j];
+            }
+            outFile << '\n';
+        }
+        outFile.precision(precision);
+    }
+
+    /* find the cities within the budget of each query "city budget" and
+     * write them as (city):dist, tab-separated, one line per query. The
+     * queries are read in batches searched concurrently by numThreads
+     * threads. used in navigationsystem.cpp */
+    void static write_isochrones(CityGraph* graph, istream& inFile,
+                                 ostream& outFile,
+                                 unsigned int numThreads = 1) {
+        const int BATCH_SIZE = 4096;  // queries held in memory at once
+        vector<pair<int, double>> queries;
+        vector<string> outputs;
+        string s;
+        while (getline(inFile, s)) {
+            istringstream ss(s);
+            string city;
+            double budget;
+            if (!(ss >> city >> budget)) continue;
+
+            // unknown cities give an empty line
+            queries.emplace_back(graph->getCityId(city), budget);
+            if (queries.size() == BATCH_SIZE) {
+                find_reachable_batch(graph, queries, outputs, numThreads);
+                for (const string& output : outputs) outFile << output;
+                queries.clear();
+            }
+        }
+
+        if (!queries.empty()) {
+            find_reachable_batch(graph, queries, outputs, numThreads);
+            for (const string& output : outputs) outFile << output;
+        }
+    }
+
+    /* find the cities within the budget of a batch of (city id, budget)
+     * queries with numThreads threads and put the printed line of query i in
+     * outputs[i] */
+    void static find_reachable_batch(const CityGraph* graph,
+                                     const vector<pair<int, double>>& queries,
+                                     vector<string>& outputs,
+                                     unsigned int numThreads) {
+        if (numThreads < 1) numThreads = 1;
+        outputs.assign(queries.size(), "\n");
+        vector<thread> workers;
+        for (unsigned int t = 0; t < numThreads; t++) {
+            workers.emplace_back([&, t]() {
+                SearchSpace space;
+                vector<pair<int, double>> reached;
+                for (size_t q = t; q < queries.size(); q += numThreads) {
+                    if (queries[q].first == -1) continue;
+                    graph->findReachable(queries[q].first, queries[q].second,
+                                         reached, space);
+                    ostringstream out;
+                    out.precision(10);
+                    for (size_t i = 0; i < reached.size(); i++) {
+                        if (i > 0) out << '\t';
+                        out << "(" << graph->getCityName(reached[i].first)
+                            << "):" << reached[i].second;
+                    }
+                    out << '\n';
+                    outputs[q] = out.str();
+                }
+            });
+        }
+        for (thread& worker : workers) {
+            worker.join();
         }
     }
 };
\ No newline at end of file
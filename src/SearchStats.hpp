@@ -0,0 +1,87 @@
+/**
+ * SearchStats.hpp
+ * Author: Yuening YANG, Shenlang ZHOU
+ *
+ * This file declares the counters of the effort of a graph search, and the
+ * counting policies the searches are instantiated with.
+ */
+#ifndef SEARCHSTATS_HPP
+#define SEARCHSTATS_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <algorithm>
+#include <iostream>
+
+using namespace std;
+
+/**
+ * This class holds the effort of one search, or the sum of several. A node
+ * is settled once its distance is final (an actor or city expanded, or an
+ * edge chosen by the spanning tree), and an edge is a road, a hierarchy arc
+ * or a movie of the actor graph.
+ */
+class SearchStats {
+  public:
+    uint64_t settled = 0;      // nodes settled
+    uint64_t scanned = 0;      // edges scanned
+    uint64_t pushes = 0;       // queue pushes
+    uint64_t pops = 0;         // queue pops, outdated entries included
+    uint64_t stalePops = 0;    // pops of outdated entries
+    uint64_t maxFrontier = 0;  // largest queue size
+
+    /* add the effort of another search, keeping the larger frontier */
+    SearchStats& operator+=(const SearchStats& other) {
+        settled += other.settled;
+        scanned += other.scanned;
+        pushes += other.pushes;
+        pops += other.pops;
+        stalePops += other.stalePops;
+        maxFrontier = max(maxFrontier, other.maxFrontier);
+        return *this;
+    }
+
+    /* print the names of the counters, tab-separated */
+    static void printHeader(ostream& out) {
+        out << "settled\tscanned\tpushes\tpops\tstale_pops\tmax_frontier";
+    }
+
+    /* print the counters in the order of printHeader */
+    void print(ostream& out) const {
+        out << settled << '\t' << scanned << '\t' << pushes << '\t' << pops
+            << '\t' << stalePops << '\t' << maxFrontier;
+    }
+};
+
+/**
+ * Counting policy that counts nothing. Searches instantiated with it compile
+ * to the same code as without counters, so only a search asked for its
+ * statistics pays for them.
+ */
+class NoCounting {
+  public:
+    void settle() {}
+    void scan(uint64_t = 1) {}
+    void push(size_t) {}
+    void pop() {}
+    void stalePop() {}
+};
+
+/* Counting policy that adds the effort of a search to stats */
+class Counting {
+  public:
+    SearchStats stats;
+
+    void settle() { stats.settled++; }
+    void scan(uint64_t count = 1) { stats.scanned += count; }
+    /* count a push leaving frontier entries in the queue */
+    void push(size_t frontier) {
+        stats.pushes++;
+        stats.maxFrontier = max<uint64_t>(stats.maxFrontier, frontier);
+    }
+    void pop() { stats.pops++; }
+    /* count an outdated entry, after its pop */
+    void stalePop() { stats.stalePops++; }
+};
+
+#endif  // SEARCHSTATS_HPP
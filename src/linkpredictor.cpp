@@ -29,11 +29,14 @@ int main(int argc, char* argv[]) {
         "./path_to_output_file2");
 
     string infoFileName, inFileName, outFileName1, outFileName2;
+    string statsFileName;
     options.allow_unrecognised_options().add_options()(
         "graphinfo", "", cxxopts::value<string>(infoFileName))(
         "input", "", cxxopts::value<string>(inFileName))(
         "outputCollaborated", "", cxxopts::value<string>(outFileName1))(
         "outputNotCollaborated", "", cxxopts::value<string>(outFileName2))(
+        "stats", "Write the search effort of each query to this file",
+        cxxopts::value<string>(statsFileName))(
         "h, help", "Print help and exit");
 
     options.parse_positional(
@@ -60,7 +63,12 @@ int main(int argc, char* argv[]) {
         ofstream outFile2;
         outFile2.open(outFileName2);
 
-        HelpUtil::predictFutureCollaboration(graph, inFile, outFile1, outFile2);
+        ofstream statsFile;
+        if (!statsFileName.empty()) statsFile.open(statsFileName);
+
+        HelpUtil::predictFutureCollaboration(
+            graph, inFile, outFile1, outFile2,
+            statsFileName.empty() ? 0 : &statsFile);
         if (!inFile.eof()) {
             cerr << "Failed to read the query file!\n";
         }
@@ -7,6 +7,7 @@
 #include <iostream>
 
 #include "ActorGraph.hpp"
+#include "HelpUtil.hpp"
 #include "cxxopts.hpp"
 
 using namespace std;
@@ -21,11 +22,20 @@ int main(int argc, char* argv[]) {
         "./path_to_output_file [debugging]");
 
     bool debugging_mode = false;
+    bool components_mode = false;
+    unsigned int numThreads = 1;
     string infoFileName, outFileName;
+    string statsFileName;
     options.allow_unrecognised_options().add_options()(
         "graphinfo", "", cxxopts::value<string>(infoFileName))(
         "output", "", cxxopts::value<string>(outFileName))(
         "debugging", "", cxxopts::value<bool>(debugging_mode))(
+        "components", "Output connected component statistics instead of MST",
+        cxxopts::value<bool>(components_mode))(
+        "threads", "Number of threads used to find the components",
+        cxxopts::value<unsigned int>(numThreads))(
+        "stats", "Write the effort of finding the MST to this file",
+        cxxopts::value<string>(statsFileName))(
         "h, help", "Print help and exit");
 
     options.parse_positional({"graphinfo", "output"});
@@ -45,8 +55,19 @@ int main(int argc, char* argv[]) {
         ofstream outFile;
         outFile.open(outFileName);
 
-        // find the shortest path
-        graph->findMST(outFile, debugging_mode);
+        if (components_mode) {
+            // find the connected components
+            graph->printComponentStats(outFile, numThreads);
+        } else if (statsFileName.empty()) {
+            // find the minimal spanning tree
+            graph->findMST(outFile, debugging_mode);
+        } else {
+            // find the minimal spanning tree, counting the effort
+            vector<SearchStats> stats(1);
+            graph->findMST(outFile, debugging_mode, stats[0]);
+            ofstream statsFile(statsFileName);
+            HelpUtil::write_stats({"mst"}, stats, statsFile);
+        }
 
         // close file
         outFile.close();
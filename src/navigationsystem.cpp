@@ -6,6 +6,7 @@
  */
 #include <fstream>
 #include <iostream>
+#include <vector>
 
 #include "CityGraph.hpp"
 #include "HelpUtil.hpp"
@@ -22,11 +23,81 @@ int main(int argc, char* argv[]) {
         "./path_to_query_file ./path_to_output_file");
 
     string cityxyFile, citypairFile, inFileName, outFileName;
+    string engineName = "astar";
+    string hierarchyFile;
+    int numLandmarks = 8;
+    string landmarkStrategy = "farthest";
+    unsigned int numThreads = 1;
+    int numAlternatives = 0;
+    string tableTargetsFile;
+    string weightsFile;
+    string hubLabelFile;
+    string snapshotFile;
+    string statsFileName;
+    bool isochroneMode = false;
+    bool coordinateMode = false;
+    bool tourMode = false;
+    bool dimacsMode = false;
     options.allow_unrecognised_options().add_options()(
         "cityxy", "", cxxopts::value<string>(cityxyFile))(
         "citypair", "", cxxopts::value<string>(citypairFile))(
         "input", "", cxxopts::value<string>(inFileName))(
         "output", "", cxxopts::value<string>(outFileName))(
+        "engine",
+        "Shortest path algorithm: astar, alt, bidir, reach, ch, cch or hl",
+        cxxopts::value<string>(engineName))(
+        "hierarchy",
+        "Contraction hierarchy file, loaded if it exists and written "
+        "otherwise",
+        cxxopts::value<string>(hierarchyFile))(
+        "hub-labels",
+        "Hub label file of the hl engine, mapped if it exists and written "
+        "otherwise",
+        cxxopts::value<string>(hubLabelFile))(
+        "snapshot",
+        "Binary snapshot of the graph with its landmarks and hierarchy, "
+        "mapped instead of reading the graph files if it was written from "
+        "them as they are, and written after preprocessing otherwise",
+        cxxopts::value<string>(snapshotFile))(
+        "weights",
+        "Road weight factors of the cch engine, as \"city1 city2 factor\" "
+        "lines",
+        cxxopts::value<string>(weightsFile))(
+        "landmarks", "Number of landmarks of the alt engine, at least 1",
+        cxxopts::value<int>(numLandmarks))(
+        "landmark-strategy",
+        "How the alt engine chooses landmarks: farthest or avoid",
+        cxxopts::value<string>(landmarkStrategy))(
+        "threads", "Number of threads searching the queries",
+        cxxopts::value<unsigned int>(numThreads))(
+        "alternatives",
+        "Also output up to this many alternative paths of each query, "
+        "tab-separated after the shortest path",
+        cxxopts::value<int>(numAlternatives))(
+        "table",
+        "Write the distance table from the cities of the query file to the "
+        "cities of this file, one per line, instead of paths",
+        cxxopts::value<string>(tableTargetsFile))(
+        "isochrone",
+        "Read queries as \"city budget\" and output all cities within the "
+        "budget with their distances",
+        cxxopts::value<bool>(isochroneMode))(
+        "dimacs",
+        "Read the graph as a DIMACS .gr file of arcs and .co file of "
+        "coordinates instead of cityxy and citypair files",
+        cxxopts::value<bool>(dimacsMode))(
+        "coordinates",
+        "Read queries as \"x1 y1 x2 y2\" and route between the nearest "
+        "cities",
+        cxxopts::value<bool>(coordinateMode))(
+        "tour",
+        "Read queries as lists of stops and output a short closed tour "
+        "through them from the first stop",
+        cxxopts::value<bool>(tourMode))(
+        "stats",
+        "Write the search effort of each shortest path query to this file; "
+        "not counted by the cch and hl engines",
+        cxxopts::value<string>(statsFileName))(
         "h, help", "Print help and exit");
 
     options.parse_positional({"cityxy", "citypair", "input", "output"});
@@ -34,24 +105,113 @@ int main(int argc, char* argv[]) {
 
     // if invalid format or using help flag, then print help and exit
     // assume the input dataset and query file is formatted well
-    if (userOptions.count("help") || outFileName.empty()) {
+    if (userOptions.count("help") || outFileName.empty() ||
+        (engineName != "astar" && engineName != "alt" &&
+         engineName != "bidir" && engineName != "reach" && engineName != "ch" &&
+         engineName != "cch" && engineName != "hl") ||
+        (landmarkStrategy != "farthest" && landmarkStrategy != "avoid") ||
+        numLandmarks < 1) {
         cout << options.help({""}) << std::endl;
         exit(0);
     }
 
     // get graph info and construct graph
     CityGraph* graph = new CityGraph();
-    if (graph->loadFromFile(cityxyFile.c_str(), citypairFile.c_str())) {
+    // a snapshot written from other graph files, or from files modified
+    // since, is rebuilt from the files
+    vector<string> sources = {cityxyFile, citypairFile};
+    bool fromSnapshot = !snapshotFile.empty() &&
+                        graph->loadSnapshot(snapshotFile.c_str(), sources);
+    bool loaded = fromSnapshot ||
+                  (dimacsMode ? graph->loadFromDimacs(cityxyFile.c_str(),
+                                                      citypairFile.c_str())
+                              : graph->loadFromFile(cityxyFile.c_str(),
+                                                    citypairFile.c_str()));
+    if (loaded) {
+        if (engineName == "alt") {
+            graph->setEngine(CityGraph::ALT);
+            // the landmarks of a snapshot are rebuilt if chosen otherwise
+            Landmarks::Strategy strategy = landmarkStrategy == "avoid"
+                                               ? Landmarks::AVOID
+                                               : Landmarks::FARTHEST;
+            if (!graph->hasLandmarks(numLandmarks, strategy)) {
+                graph->buildLandmarks(numLandmarks, strategy);
+            }
+        } else if (engineName == "bidir") {
+            graph->setEngine(CityGraph::BIDIRECTIONAL_ASTAR);
+        } else if (engineName == "reach") {
+            graph->setEngine(CityGraph::REACH);
+            graph->buildReaches(numThreads);
+        } else if (engineName == "cch") {
+            graph->setEngine(CityGraph::CUSTOMIZABLE_HIERARCHY);
+            graph->buildCustomizableHierarchy(numThreads);
+            if (!weightsFile.empty() &&
+                !graph->loadRoadWeights(weightsFile.c_str(), numThreads)) {
+                cerr << "Failed to read " << weightsFile << "!\n";
+            }
+        } else if (engineName == "hl") {
+            graph->setEngine(CityGraph::HUB_LABELS);
+            // reuse the labels of a previous run if possible
+            if (!hubLabelFile.empty() &&
+                !graph->loadHubLabels(hubLabelFile.c_str()) &&
+                !graph->saveHubLabels(hubLabelFile.c_str())) {
+                cerr << "Failed to write " << hubLabelFile << "!\n";
+            }
+        } else if (engineName == "ch") {
+            graph->setEngine(CityGraph::CONTRACTION_HIERARCHY);
+            // reuse the preprocessing of a previous run if possible
+            if (!hierarchyFile.empty() &&
+                !graph->loadHierarchy(hierarchyFile.c_str()) &&
+                !graph->saveHierarchy(hierarchyFile.c_str())) {
+                cerr << "Failed to write " << hierarchyFile << "!\n";
+            }
+        }
+
+        // save the graph with the preprocessing of the engine for next runs
+        if (!snapshotFile.empty() && !fromSnapshot) {
+            graph->prepareEngine();
+            if (!graph->saveSnapshot(snapshotFile.c_str(), sources)) {
+                cerr << "Failed to write " << snapshotFile << "!\n";
+            }
+        }
+
         // prepare the query and output file
         ifstream inFile;
         inFile.open(inFileName);
         ofstream outFile;
         outFile.open(outFileName);
 
-        // find the shortest path
-        HelpUtil::find_AStar_paths(graph, inFile, outFile);
-        if (!inFile.eof()) {
-            cerr << "Failed to read the query file!\n";
+        if (isochroneMode) {
+            // cities within a distance budget of each query city
+            HelpUtil::write_isochrones(graph, inFile, outFile, numThreads);
+        } else if (coordinateMode) {
+            // snap the coordinates to the nearest cities
+            HelpUtil::find_coordinate_paths(graph, inFile, outFile,
+                                            numThreads);
+        } else if (tourMode) {
+            // the whole route of a tour through the stops
+            HelpUtil::find_tours(graph, inFile, outFile, numThreads);
+        } else if (numAlternatives > 0) {
+            // the shortest path and its alternatives
+            HelpUtil::find_alternative_paths(graph, inFile, outFile,
+                                             numAlternatives, numThreads);
+        } else if (!tableTargetsFile.empty()) {
+            // distances between all pairs of the 2 city lists
+            ifstream targetFile(tableTargetsFile);
+            if (!targetFile) {
+                cerr << "Failed to read " << tableTargetsFile << "!\n";
+            }
+            HelpUtil::write_distance_table(graph, inFile, targetFile, outFile,
+                                           numThreads);
+        } else {
+            // find the shortest path, counting the search effort if asked
+            ofstream statsFile;
+            if (!statsFileName.empty()) statsFile.open(statsFileName);
+            HelpUtil::find_AStar_paths(graph, inFile, outFile, numThreads,
+                                       statsFileName.empty() ? 0 : &statsFile);
+            if (!inFile.eof()) {
+                cerr << "Failed to read the query file!\n";
+            }
         }
 
         // close file
@@ -24,12 +24,29 @@ int main(int argc, char* argv[]) {
 
     char findMode;
     string infoFileName, inFileName, outFileName;
+    int numLandmarks = 0;
+    bool estimate_mode = false;
+    string labelsFileName;
+    string statsFileName;
     options.allow_unrecognised_options().add_options()(
         "graphinfo", "", cxxopts::value<string>(infoFileName))(
         "mode", "Find the shortest path of weighted(w) or unweighted(u) graph",
         cxxopts::value<char>(findMode))("input", "",
                                         cxxopts::value<string>(inFileName))(
         "output", "", cxxopts::value<string>(outFileName))(
+        "landmarks",
+        "Number of hub actors used as landmarks to speed up weighted queries",
+        cxxopts::value<int>(numLandmarks))(
+        "estimate",
+        "Only output lower and upper bounds of the weighted distances, "
+        "computed from the landmarks",
+        cxxopts::value<bool>(estimate_mode))(
+        "labels",
+        "Hop distance labels file for unweighted queries, loaded if it "
+        "exists and written otherwise",
+        cxxopts::value<string>(labelsFileName))(
+        "stats", "Write the search effort of each query to this file",
+        cxxopts::value<string>(statsFileName))(
         "h, help", "Print help and exit");
 
     options.parse_positional({"graphinfo", "mode", "input", "output"});
@@ -63,8 +80,27 @@ int main(int argc, char* argv[]) {
         ofstream outFile;
         outFile.open(outFileName);
 
-        // find the shortest path
-        HelpUtil::find_graph_paths(graph, inFile, outFile, use_weighted_edges);
+        if (numLandmarks > 0) {
+            graph->buildLandmarks(numLandmarks);
+        }
+        // reuse the labels of a previous run if possible
+        if (!use_weighted_edges && !labelsFileName.empty() &&
+            !graph->loadHopLabels(labelsFileName.c_str()) &&
+            !graph->saveHopLabels(labelsFileName.c_str())) {
+            cerr << "Failed to write " << labelsFileName << "!\n";
+        }
+
+        if (estimate_mode) {
+            // estimate the distances
+            HelpUtil::estimate_graph_distances(graph, inFile, outFile);
+        } else {
+            // find the shortest path, counting the search effort if asked
+            ofstream statsFile;
+            if (!statsFileName.empty()) statsFile.open(statsFileName);
+            HelpUtil::find_graph_paths(graph, inFile, outFile,
+                                       use_weighted_edges,
+                                       statsFileName.empty() ? 0 : &statsFile);
+        }
         if (!inFile.eof()) {
             cerr << "Failed to read the query file!\n";
         }
@@ -6,6 +6,7 @@
  */
 #include <gtest/gtest.h>
 #include <iostream>
+#include <iterator>
 #include "ActorGraph.hpp"
 #include "HelpUtil.hpp"
 
@@ -138,6 +139,130 @@ TEST_F(SmallWeightedGraphFixture, WEIGHTED_SHORTEST_PATH_TEST) {
     EXPECT_EQ(os.str(), "\n");
 }
 
+/* check that actors in different components are labeled apart */
+TEST_F(SmallUnweightedGraphFixture, COMPONENTS_TEST) {
+    graph.insert("Loner", "Unknown Movie", 2000, false);
+    graph.buildComponents();
+    auto actors = graph.getActors();
+    EXPECT_EQ(actors.at("Kevin Bacon")->component,
+              actors.at("Tom Holland")->component);
+    EXPECT_NE(actors.at("Kevin Bacon")->component,
+              actors.at("Loner")->component);
+
+    // disconnected pairs are rejected with an empty line
+    ostringstream os;
+    graph.find_path("Kevin Bacon", "Loner", os, false);
+    EXPECT_EQ(os.str(), "\n");
+    os.str("");
+
+    // new movie joins the components again
+    graph.insert("Loner", "Glass", 2019, false);
+    graph.find_path("Samuel L. Jackson", "Loner", os, false);
+    EXPECT_EQ(os.str(), "(Samuel L. Jackson)--[Glass#@2019]-->(Loner)\n");
+}
+
+/* check that component labels do not depend on the number of threads */
+TEST_F(SmallUnweightedGraphFixture, PARALLEL_COMPONENTS_TEST) {
+    graph.insert("Loner", "Unknown Movie", 2000, false);
+    graph.insert("Another Loner", "Unknown Movie", 2000, false);
+    graph.buildComponents(4);
+    auto actors = graph.getActors();
+    // labels are numbered by the first actor name of each component
+    EXPECT_EQ(actors.at("Another Loner")->component, 0);
+    EXPECT_EQ(actors.at("Loner")->component, 0);
+    EXPECT_EQ(actors.at("James McAvoy")->component, 1);
+    EXPECT_EQ(actors.at("Tom Holland")->component, 1);
+
+    ostringstream os;
+    graph.printComponentStats(os, 4);
+    EXPECT_EQ(os.str(),
+              "#NODE: 9\n#COMPONENTS: 2\nLARGEST COMPONENT: 7\nISOLATED "
+              "ACTORS: 0\n");
+}
+
+/* check landmark A* and distance estimates in weighted mode */
+TEST_F(SmallWeightedGraphFixture, LANDMARKS_TEST) {
+    graph.buildLandmarks(2);
+    ostringstream os;
+    graph.find_path("Kevin Bacon", "Tom Holland", os, true);
+    EXPECT_EQ(os.str(),
+              "(Kevin Bacon)--[X-Men: First Class#@2011]-->(James "
+              "McAvoy)--[Glass#@2019]-->(Samuel L. Jackson)--[Avengers: "
+              "Endgame#@2019]-->(Robert Downey Jr.)--[Spider-Man: "
+              "Homecoming#@2017]-->(Tom Holland)\n");
+    os.str("");
+
+    // the true distance 9 + 1 + 1 + 3 = 14 lies within the bounds
+    graph.estimate_distance("Kevin Bacon", "Tom Holland", os);
+    istringstream is(os.str());
+    unsigned int lower, upper;
+    is >> lower >> upper;
+    EXPECT_LE(lower, 14);
+    EXPECT_GE(upper, 14);
+    os.str("");
+
+    graph.estimate_distance("Kevin Bacon", "Nobody", os);
+    EXPECT_EQ(os.str(), "\n");
+}
+
+/* check hop distances and paths from the pruned landmark labels */
+TEST_F(SmallUnweightedGraphFixture, HOP_LABELS_TEST) {
+    graph.insert("Loner", "Unknown Movie", 2000, false);
+    for (int roots : {0, 1, 2}) {
+        graph.buildHopLabels(roots);
+        EXPECT_EQ(graph.hop_distance("Kevin Bacon", "Kevin Bacon"), 0);
+        EXPECT_EQ(graph.hop_distance("Kevin Bacon", "James McAvoy"), 1);
+        EXPECT_EQ(graph.hop_distance("Kevin Bacon", "Tom Holland"), 3);
+        EXPECT_EQ(graph.hop_distance("Samuel L. Jackson", "Tom Holland"), 2);
+        EXPECT_EQ(graph.hop_distance("Kevin Bacon", "Loner"), -1);
+        EXPECT_EQ(graph.hop_distance("Kevin Bacon", "Nobody"), -1);
+    }
+
+    // labels are saved, and only loaded for the same graph
+    string filename = "test_ActorGraph_labels.bin";
+    ASSERT_TRUE(graph.saveHopLabels(filename.c_str()));
+    ActorGraph other;
+    other.insert("Kevin Bacon", "X-Men: First Class", 2011, false);
+    EXPECT_FALSE(other.loadHopLabels(filename.c_str()));
+    // nor for the same cast in other movies
+    ActorGraph recast;
+    for (const auto& actor : graph.getActors()) {
+        recast.insert(actor.first, "Reunion", 2020, false);
+    }
+    EXPECT_FALSE(recast.loadHopLabels(filename.c_str()));
+
+    // truncated or corrupt files are rejected, even with a huge array size
+    ifstream saved(filename, ios::binary);
+    string content((istreambuf_iterator<char>(saved)),
+                   istreambuf_iterator<char>());
+    saved.close();
+    string badFile = "test_ActorGraph_bad_labels.bin";
+    // after the magic, the graph hash and the numbers of actors and roots
+    size_t sizeOffset = 8 + sizeof(unsigned long long) + 2 * sizeof(int);
+    string huge = content;
+    huge.replace(sizeOffset, sizeof(unsigned long long),
+                 sizeof(unsigned long long), '\xff');
+    for (const string& bad : {content.substr(0, content.size() - 1), huge}) {
+        ofstream out(badFile, ios::binary);
+        out << bad;
+        out.close();
+        EXPECT_FALSE(graph.loadHopLabels(badFile.c_str()));
+    }
+    remove(badFile.c_str());
+    ASSERT_TRUE(graph.loadHopLabels(filename.c_str()));
+    remove(filename.c_str());
+
+    ostringstream os;
+    graph.find_path("Kevin Bacon", "Tom Holland", os, false);
+    EXPECT_EQ(os.str(),
+              "(Kevin Bacon)--[X-Men: First Class#@2011]-->(Michael "
+              "Fassbender)--[Alien: Covenant#@2017]-->(Katherine "
+              "Waterston)--[The Current War#@2017]-->(Tom Holland)\n");
+    os.str("");
+    graph.find_path("Kevin Bacon", "Loner", os, false);
+    EXPECT_EQ(os.str(), "\n");
+}
+
 /* check whether predictlink works well */
 TEST_F(SmallUnweightedGraphFixture, PREDICT_LINK_TEST) {
     ostringstream os1;
@@ -242,6 +367,46 @@ TEST_F(SmallUnweightedGraphFixture, HELP_UTIL_PREDICT_LINK_TEST) {
               "Jackson\t\n");
 }
 
+/* test counting the effort of the searches */
+TEST_F(SmallWeightedGraphFixture, SEARCH_STATS_TEST) {
+    ostringstream expected;
+    graph.find_path("James McAvoy", "Kevin Bacon", expected, true);
+    ostringstream os;
+    SearchStats stats;
+    graph.find_path("James McAvoy", "Kevin Bacon", os, true, stats);
+    // counting does not change the path
+    EXPECT_EQ(os.str(), expected.str());
+    EXPECT_GT(stats.settled, 0);
+    EXPECT_GT(stats.scanned, 0);
+    EXPECT_GE(stats.pushes, stats.pops);
+    // every pop either settles an actor or is an outdated entry
+    EXPECT_EQ(stats.pops, stats.settled + stats.stalePops);
+
+    // B finds a shorter way to A, which is pushed twice and settled once
+    ActorGraph detour;
+    detour.insert("S", "Old", 2000, true);
+    detour.insert("A", "Old", 2000, true);
+    detour.insert("S", "New", 2019, true);
+    detour.insert("B", "New", 2019, true);
+    detour.insert("B", "Sequel", 2018, true);
+    detour.insert("A", "Sequel", 2018, true);
+    detour.insert("A", "Remake", 2000, true);
+    detour.insert("T", "Remake", 2000, true);
+    SearchStats detourStats;
+    os.str("");
+    detour.find_path("S", "T", os, true, detourStats);
+    EXPECT_EQ(os.str(), "(S)--[New#@2019]-->(B)--[Sequel#@2018]-->(A)--"
+                        "[Remake#@2000]-->(T)\n");
+    EXPECT_EQ(detourStats.settled, 3);
+    EXPECT_EQ(detourStats.stalePops, 1);
+
+    SearchStats mstStats;
+    os.str("");
+    graph.findMST(os, true, mstStats);
+    EXPECT_EQ(mstStats.settled, 6);  // edges chosen
+    EXPECT_GT(mstStats.scanned, 0);
+}
+
 /* test load function */
 TEST(ActorGraphTests, LOAD_TEST) {
     string infoFileName = "/Code/cse100_pa4/data/imdb_small_sample.tsv";
@@ -5,7 +5,10 @@
  * Email: y3yang@ucse.edu
  */
 #include <gtest/gtest.h>
+#include <math.h>
+#include <algorithm>
 #include <iostream>
+#include <iterator>
 #include "CityGraph.hpp"
 #include "HelpUtil.hpp"
 
@@ -68,6 +71,465 @@ TEST_F(SmallCityGraphFixture, A_START_SEARCH_TEST) {
     EXPECT_EQ(os.str(), "\n");
 }
 
+/* check that search state does not leak between consecutive queries */
+TEST_F(SmallCityGraphFixture, REPEATED_QUERY_TEST) {
+    ostringstream os;
+    graph.find_path("A", "C", os);
+    graph.find_path("C", "B", os);
+    graph.find_path("A", "C", os);
+    graph.find_path("B", "A", os);
+    EXPECT_EQ(os.str(),
+              "(A)-->(D)-->(C)\n(C)-->(E)-->(B)\n(A)-->(D)-->(C)\n(B)-->(A)\n");
+}
+
+/* check that cities in different components are labeled apart */
+TEST_F(SmallCityGraphFixture, COMPONENTS_TEST) {
+    EXPECT_EQ(graph.getComponent("A"), graph.getComponent("C"));
+    EXPECT_NE(graph.getComponent("A"), graph.getComponent("F"));
+    EXPECT_EQ(graph.getComponent("Nowhere"), -1);
+
+    // connecting F merges the components
+    graph.insertRoad("C", "F");
+    ostringstream os;
+    graph.find_path("A", "F", os);
+    EXPECT_EQ(os.str(), "(A)-->(D)-->(C)-->(F)\n");
+}
+
+/* check that the contraction hierarchy finds the same paths as A* */
+TEST_F(SmallCityGraphFixture, CONTRACTION_HIERARCHY_TEST) {
+    vector<string> cities = {"A", "B", "C", "D", "E", "F", "Nowhere"};
+    ostringstream expected;
+    for (string start : cities) {
+        for (string end : cities) {
+            graph.find_path(start, end, expected);
+        }
+    }
+
+    graph.setEngine(CityGraph::CONTRACTION_HIERARCHY);
+    ostringstream os;
+    for (string start : cities) {
+        for (string end : cities) {
+            graph.find_path(start, end, os);
+        }
+    }
+    EXPECT_EQ(os.str(), expected.str());
+
+    // the hierarchy can be saved and reused
+    string filename = "test_CityGraph_hierarchy.bin";
+    ASSERT_TRUE(graph.saveHierarchy(filename.c_str()));
+    CityGraph other;
+    other.insertCity("A", 0, 3);
+    EXPECT_FALSE(other.loadHierarchy(filename.c_str()));
+    // nor for the same cities linked by other roads
+    CityGraph rerouted;
+    for (string city : {"A", "B", "C", "D", "E", "F"}) {
+        rerouted.insertCity(city, 0, 0);
+    }
+    rerouted.insertRoad("A", "B");
+    rerouted.insertRoad("B", "C");
+    EXPECT_FALSE(rerouted.loadHierarchy(filename.c_str()));
+
+    // truncated or corrupt files are rejected, even with a huge array size
+    ifstream saved(filename, ios::binary);
+    string content((istreambuf_iterator<char>(saved)),
+                   istreambuf_iterator<char>());
+    saved.close();
+    string badFile = "test_CityGraph_bad_hierarchy.bin";
+    // after the magic, the graph hash and the number of cities
+    size_t sizeOffset = 8 + sizeof(unsigned long long) + sizeof(int);
+    string huge = content;
+    huge.replace(sizeOffset, sizeof(unsigned long long),
+                 sizeof(unsigned long long), '\xff');
+    for (const string& bad : {content.substr(0, content.size() - 4), huge}) {
+        ofstream out(badFile, ios::binary);
+        out << bad;
+        out.close();
+        EXPECT_FALSE(graph.loadHierarchy(badFile.c_str()));
+    }
+    remove(badFile.c_str());
+    EXPECT_TRUE(graph.loadHierarchy(filename.c_str()));
+    os.str("");
+    graph.find_path("A", "C", os);
+    EXPECT_EQ(os.str(), "(A)-->(D)-->(C)\n");
+    remove(filename.c_str());
+}
+
+/* check that landmark bounds are valid and ALT finds the A* paths */
+TEST_F(SmallCityGraphFixture, ALT_TEST) {
+    graph.buildIndex();
+    Landmarks landmarks;
+    landmarks.build(graph, 2, Landmarks::FARTHEST);
+    // F is unreachable from the first landmark, so it becomes the second
+    ASSERT_EQ(landmarks.getLandmarks().size(), 2);
+    EXPECT_EQ(graph.getCityName(landmarks.getLandmarks()[1]), "F");
+    // dist(A, C) = dist(A, D) + dist(D, C) = sqrt(5) + sqrt(29)
+    int a = graph.getCityId("A");
+    int c = graph.getCityId("C");
+    EXPECT_LE(landmarks.lowerBound(a, c), sqrt(5) + sqrt(29) + 1e-9);
+    EXPECT_EQ(landmarks.lowerBound(a, graph.getCityId("F")), 0);
+
+    // the avoid strategy builds as many landmarks as asked, even once the
+    // bounds are exact from the roots it draws
+    landmarks.build(graph, 6, Landmarks::AVOID);
+    EXPECT_EQ(landmarks.getLandmarks().size(), 6u);
+    EXPECT_EQ(landmarks.getNumRequested(), 6);
+    EXPECT_EQ(landmarks.getStrategy(), Landmarks::AVOID);
+    landmarks.build(graph, 0, Landmarks::FARTHEST);
+    EXPECT_TRUE(landmarks.getLandmarks().empty());
+
+    for (auto strategy : {Landmarks::FARTHEST, Landmarks::AVOID}) {
+        graph.setEngine(CityGraph::ALT);
+        graph.buildLandmarks(3, strategy);
+        ostringstream os;
+        graph.find_path("A", "C", os);
+        graph.find_path("B", "C", os);
+        graph.find_path("A", "F", os);
+        EXPECT_EQ(os.str(), "(A)-->(D)-->(C)\n(B)-->(E)-->(C)\n\n");
+    }
+}
+
+/* test that landmarks only change the searches of the ALT engine */
+TEST(CityGraphTests, ALT_ENGINE_ONLY_TEST) {
+    // T is straight ahead of S, but the road goes around through M, past a
+    // dead end D the straight-line bound leads to
+    CityGraph graph;
+    graph.insertCity("S", 0, 0);
+    graph.insertCity("T", 10, 0);
+    graph.insertCity("M", 5, 8);
+    graph.insertCity("D1", 3, 0);
+    graph.insertCity("D2", 6, 0);
+    graph.insertCity("D3", 9, -1);
+    graph.insertRoad("S", "M");
+    graph.insertRoad("M", "T");
+    graph.insertRoad("S", "D1");
+    graph.insertRoad("D1", "D2");
+    graph.insertRoad("D2", "D3");
+
+    graph.setEngine(CityGraph::ASTAR);
+    ostringstream expected;
+    SearchStats astarStats;
+    graph.find_path("S", "T", expected, astarStats);
+    graph.buildLandmarks(2);
+    ostringstream os;
+    SearchStats stats;
+    graph.find_path("S", "T", os, stats);
+    EXPECT_EQ(os.str(), expected.str());
+    EXPECT_EQ(stats.settled, astarStats.settled);
+
+    graph.setEngine(CityGraph::ALT);
+    SearchStats altStats;
+    os.str("");
+    graph.find_path("S", "T", os, altStats);
+    EXPECT_EQ(os.str(), expected.str());
+    EXPECT_LT(altStats.settled, astarStats.settled);
+}
+
+/* test the bidirectional A* engine against A* */
+TEST_F(SmallCityGraphFixture, BIDIRECTIONAL_ASTAR_TEST) {
+    const char* names[] = {"A", "B", "C", "D", "E", "F"};
+    for (const char* from : names) {
+        for (const char* to : names) {
+            ostringstream expected;
+            graph.setEngine(CityGraph::ASTAR);
+            graph.find_path(from, to, expected);
+            ostringstream os;
+            graph.setEngine(CityGraph::BIDIRECTIONAL_ASTAR);
+            graph.find_path(from, to, os);
+            EXPECT_EQ(os.str(), expected.str()) << from << " " << to;
+        }
+    }
+}
+
+/* test the many-to-many distance table */
+TEST_F(SmallCityGraphFixture, DISTANCE_TABLE_TEST) {
+    vector<double> table;
+    graph.distanceTable({"A", "B", "X"}, {"C", "F", "A", "B"}, table, 2);
+    vector<double> expected = {sqrt(5) + sqrt(29), -1, 0, 2,
+                               sqrt(18) + sqrt(10), -1, 2, 0,
+                               -1, -1, -1, -1};
+    ASSERT_EQ(table.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); i++) {
+        EXPECT_NEAR(table[i], expected[i], 1e-9) << i;
+    }
+}
+
+/* test the isochrone queries */
+TEST_F(SmallCityGraphFixture, ISOCHRONE_TEST) {
+    istringstream is("A 2.5\nF 100\nX 1\nB 0\n");
+    ostringstream os;
+    HelpUtil::write_isochrones(&graph, is, os, 2);
+    // B is 2 away, D sqrt(5), E sqrt(34)
+    EXPECT_EQ(os.str(), "(A):0\t(B):2\t(D):2.236067977\n(F):0\n\n(B):0\n");
+}
+
+/* test the nearest city and box lookups */
+TEST_F(SmallCityGraphFixture, SPATIAL_INDEX_TEST) {
+    EXPECT_EQ(graph.getCityName(graph.findNearestCity(9, 9)), "F");
+    EXPECT_EQ(graph.getCityName(graph.findNearestCity(0.8, 3.1)), "A");
+    vector<int> cities;
+    graph.findNearestCities(1, 4, 3, cities);
+    ASSERT_EQ(cities.size(), 3);
+    // A and B are both sqrt(2) away, the tie goes to the lower id
+    EXPECT_EQ(graph.getCityName(cities[0]), "D");
+    EXPECT_EQ(graph.getCityName(cities[1]), "A");
+    EXPECT_EQ(graph.getCityName(cities[2]), "B");
+    graph.findCitiesInBox(1, 0, 6, 3, cities);
+    ASSERT_EQ(cities.size(), 3);
+    EXPECT_EQ(graph.getCityName(cities[0]), "B");
+    EXPECT_EQ(graph.getCityName(cities[1]), "C");
+    EXPECT_EQ(graph.getCityName(cities[2]), "E");
+
+    // random points against a linear scan
+    SpatialIndex index;
+    vector<double> xs, ys;
+    for (int i = 0; i < 500; i++) {
+        xs.push_back((i * 7919) % 101);
+        ys.push_back((i * 104729) % 97);
+    }
+    index.build(xs.data(), ys.data(), xs.size());
+    for (int q = 0; q < 50; q++) {
+        double x = (q * 31) % 103 + 0.5;
+        double y = (q * 17) % 89 + 0.25;
+        vector<pair<double, int>> expected;
+        for (size_t i = 0; i < xs.size(); i++) {
+            expected.emplace_back(pow(xs[i] - x, 2) + pow(ys[i] - y, 2), i);
+        }
+        sort(expected.begin(), expected.end());
+        index.nearest(x, y, 5, cities);
+        ASSERT_EQ(cities.size(), 5);
+        for (int i = 0; i < 5; i++) {
+            EXPECT_EQ(cities[i], expected[i].second);
+        }
+    }
+}
+
+/* test the customizable hierarchy with new road weights */
+TEST_F(SmallCityGraphFixture, CUSTOMIZABLE_HIERARCHY_TEST) {
+    graph.setEngine(CityGraph::CUSTOMIZABLE_HIERARCHY);
+    ostringstream os;
+    graph.find_path("A", "C", os);
+    graph.find_path("B", "C", os);
+    graph.find_path("A", "F", os);
+    EXPECT_EQ(os.str(), "(A)-->(D)-->(C)\n(B)-->(E)-->(C)\n\n");
+
+    // slow down D-C, then both paths go through E
+    string filename = "/tmp/test_city_weights.txt";
+    ofstream out(filename);
+    out << "D C 3\nX C 1\n";
+    out.close();
+    ASSERT_TRUE(graph.loadRoadWeights(filename.c_str(), 2));
+    os.str("");
+    graph.find_path("A", "C", os);
+    graph.find_path("C", "B", os);
+    EXPECT_EQ(os.str(), "(A)-->(E)-->(C)\n(C)-->(E)-->(B)\n");
+
+    // negative and zero factors are rejected and keep the previous weights
+    for (const char* factor : {"-5", "0"}) {
+        out.open(filename);
+        out << "D C 1\nA E " << factor << "\n";
+        out.close();
+        EXPECT_FALSE(graph.loadRoadWeights(filename.c_str())) << factor;
+    }
+    os.str("");
+    graph.find_path("A", "C", os);
+    EXPECT_EQ(os.str(), "(A)-->(E)-->(C)\n");
+    remove(filename.c_str());
+    EXPECT_FALSE(graph.loadRoadWeights(filename.c_str()));
+}
+
+/* test the reach values and the reach engine against A* */
+TEST_F(SmallCityGraphFixture, REACH_TEST) {
+    graph.buildIndex();
+    ReachIndex reaches;
+    reaches.build(graph, 2);
+    // E is sqrt(10) from an end of B-E-C, and its bound is no less. F is on
+    // no shortest path
+    EXPECT_GE(reaches.getReach(graph.getCityId("E")), sqrt(10) - 1e-9);
+    EXPECT_EQ(reaches.getReach(graph.getCityId("F")), 0);
+
+    graph.buildReaches(2);
+    const char* names[] = {"A", "B", "C", "D", "E", "F"};
+    for (const char* from : names) {
+        for (const char* to : names) {
+            ostringstream expected;
+            graph.setEngine(CityGraph::ASTAR);
+            graph.find_path(from, to, expected);
+            ostringstream os;
+            graph.setEngine(CityGraph::REACH);
+            graph.find_path(from, to, os);
+            EXPECT_EQ(os.str(), expected.str()) << from << " " << to;
+        }
+    }
+}
+
+/* test the reach bounds of a grid too big for a single round against A* */
+TEST(CityGraphTests, REACH_ROUNDS_TEST) {
+    CityGraph graph;
+    const int side = 40;
+    for (int i = 0; i < side; i++) {
+        for (int j = 0; j < side; j++) {
+            // a jittered grid, so shortest paths are unique
+            int x = i * 100 + (i * 7919 + j * 104729) % 37;
+            int y = j * 100 + (i * 31 + j * 17) % 41;
+            graph.insertCity(to_string(i * side + j), x, y);
+        }
+    }
+    for (int i = 0; i < side; i++) {
+        for (int j = 0; j < side; j++) {
+            string city = to_string(i * side + j);
+            if (i + 1 < side) {
+                graph.insertRoad(city, to_string((i + 1) * side + j));
+            }
+            if (j + 1 < side) {
+                graph.insertRoad(city, to_string(i * side + j + 1));
+            }
+        }
+    }
+    graph.buildReaches(3);
+    for (int q = 0; q < 100; q++) {
+        string from = to_string((q * 7919) % (side * side));
+        string to = to_string((q * 104729 + 13) % (side * side));
+        ostringstream expected;
+        graph.setEngine(CityGraph::ASTAR);
+        graph.find_path(from, to, expected);
+        ostringstream os;
+        graph.setEngine(CityGraph::REACH);
+        graph.find_path(from, to, os);
+        EXPECT_EQ(os.str(), expected.str()) << from << " " << to;
+    }
+}
+
+/* test the hub labels against A*, and their save and load */
+TEST_F(SmallCityGraphFixture, HUB_LABELS_TEST) {
+    const char* names[] = {"A", "B", "C", "D", "E", "F"};
+    string filename = "/tmp/test_city_hub_labels.bin";
+    for (int round = 0; round < 2; round++) {
+        graph.setEngine(CityGraph::HUB_LABELS);
+        if (round == 0) {
+            ASSERT_TRUE(graph.saveHubLabels(filename.c_str()));
+        } else {
+            ASSERT_TRUE(graph.loadHubLabels(filename.c_str()));
+        }
+        for (const char* from : names) {
+            for (const char* to : names) {
+                ostringstream expected;
+                graph.setEngine(CityGraph::ASTAR);
+                graph.find_path(from, to, expected);
+                ostringstream os;
+                graph.setEngine(CityGraph::HUB_LABELS);
+                graph.find_path(from, to, os);
+                EXPECT_EQ(os.str(), expected.str()) << from << " " << to;
+            }
+        }
+    }
+    // the labels are refused for the same cities linked by other roads
+    CityGraph rerouted;
+    for (string city : {"A", "B", "C", "D", "E", "F"}) {
+        rerouted.insertCity(city, 0, 0);
+    }
+    rerouted.insertRoad("A", "B");
+    rerouted.insertRoad("B", "C");
+    EXPECT_FALSE(rerouted.loadHubLabels(filename.c_str()));
+    remove(filename.c_str());
+    EXPECT_FALSE(graph.loadHubLabels(filename.c_str()));
+}
+
+/* test saving a snapshot with its preprocessing and mapping it back */
+TEST_F(SmallCityGraphFixture, SNAPSHOT_TEST) {
+    const char* names[] = {"A", "B", "C", "D", "E", "F"};
+    string filename = "/tmp/test_city_graph.snapshot";
+    graph.buildLandmarks(2);
+    graph.buildHierarchy();
+    ASSERT_TRUE(graph.saveSnapshot(filename.c_str()));
+
+    CityGraph loaded;
+    ASSERT_TRUE(loaded.loadSnapshot(filename.c_str()));
+    EXPECT_TRUE(loaded.hasLandmarks());
+    // with the settings they were built with
+    EXPECT_TRUE(loaded.hasLandmarks(2, Landmarks::FARTHEST));
+    EXPECT_FALSE(loaded.hasLandmarks(2, Landmarks::AVOID));
+    EXPECT_FALSE(loaded.hasLandmarks(8, Landmarks::FARTHEST));
+    EXPECT_EQ(loaded.getNumCities(), 6);
+    EXPECT_EQ(loaded.getCityId("D"), 3);
+    EXPECT_EQ(loaded.getCityId("X"), -1);
+    EXPECT_EQ(loaded.getComponent("F"), graph.getComponent("F"));
+    EXPECT_EQ(loaded.getCityName(loaded.findNearestCity(4.5, 0.5)), "E");
+    for (auto engine : {CityGraph::ASTAR, CityGraph::ALT,
+                        CityGraph::CONTRACTION_HIERARCHY}) {
+        graph.setEngine(engine);
+        loaded.setEngine(engine);
+        for (const char* from : names) {
+            for (const char* to : names) {
+                ostringstream expected;
+                graph.find_path(from, to, expected);
+                ostringstream os;
+                loaded.find_path(from, to, os);
+                EXPECT_EQ(os.str(), expected.str()) << from << " " << to;
+            }
+        }
+    }
+
+    // other files are rejected and leave the graph as it was
+    string badFile = "/tmp/test_city_graph_bad.snapshot";
+    ofstream bad(badFile);
+    bad << "A 0 3\n";
+    bad.close();
+    EXPECT_FALSE(loaded.loadSnapshot(badFile.c_str()));
+    EXPECT_EQ(loaded.getCityId("D"), 3);
+
+    // a snapshot stamped with its source files is refused once they change
+    vector<string> sources = {badFile};
+    ASSERT_TRUE(graph.saveSnapshot(filename.c_str(), sources));
+    EXPECT_TRUE(loaded.loadSnapshot(filename.c_str(), sources));
+    EXPECT_FALSE(loaded.loadSnapshot(filename.c_str()));
+    bad.open(badFile, ios::app);
+    bad << "B 2 3\n";
+    bad.close();
+    EXPECT_FALSE(loaded.loadSnapshot(filename.c_str(), sources));
+    remove(badFile.c_str());
+    EXPECT_FALSE(loaded.loadSnapshot(filename.c_str(), sources));
+    remove(filename.c_str());
+}
+
+/* test tours through several stops */
+TEST_F(SmallCityGraphFixture, TOUR_TEST) {
+    // the best tour of A, C and E goes around the triangle A-D-C-E
+    vector<int> route;
+    double length = graph.findTour({"A", "C", "E"}, route);
+    double expected = sqrt(5) + sqrt(29) + sqrt(10) + sqrt(34);
+    EXPECT_NEAR(length, expected, 1e-9);
+    ASSERT_EQ(route.size(), 5);
+    EXPECT_EQ(graph.getCityName(route[0]), "A");
+    EXPECT_EQ(graph.getCityName(route[4]), "A");
+    EXPECT_EQ(graph.findTour({"A"}, route), 0);
+    EXPECT_EQ(route.size(), 1);
+    EXPECT_EQ(graph.findTour({"A", "F"}, route), -1);
+    EXPECT_TRUE(route.empty());
+
+    // points of a circle in shuffled order are toured around the circle
+    int n = 40;
+    vector<int> angles(n);
+    for (int i = 0; i < n; i++) {
+        angles[i] = (i * 17) % n;
+    }
+    vector<double> table(n * n);
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            double angle = 2 * M_PI * (angles[i] - angles[j]) / n;
+            table[i * n + j] = 2 * fabs(sin(angle / 2));
+        }
+    }
+    TourPlanner planner(table, n);
+    vector<int> tour;
+    EXPECT_NEAR(planner.plan(tour, 8, 3), 2 * n * sin(M_PI / n), 1e-9);
+    ASSERT_EQ(tour.size(), n);
+    EXPECT_EQ(tour[0], 0);
+    for (int i = 0; i < n; i++) {
+        int step = (angles[tour[(i + 1) % n]] - angles[tour[i]] + n) % n;
+        EXPECT_TRUE(step == 1 || step == n - 1);
+    }
+}
+
 /* test navigatesystem helper method */
 TEST_F(SmallCityGraphFixture, HELP_UTIL_FIND_ASTAR_TEST) {
     istringstream is;
@@ -79,6 +541,228 @@ TEST_F(SmallCityGraphFixture, HELP_UTIL_FIND_ASTAR_TEST) {
     EXPECT_EQ(os.str(), "(A)-->(D)-->(C)\n\n");
 }
 
+/* test navigatesystem helper method with several threads */
+TEST_F(SmallCityGraphFixture, HELP_UTIL_THREADS_TEST) {
+    string queries = "A C\nA F\nB C\nC A\nA X\nF F\nE D\n";
+    istringstream serialIn(queries);
+    ostringstream expected;
+    HelpUtil::find_AStar_paths(&graph, serialIn, expected);
+
+    for (auto engine : {CityGraph::ASTAR, CityGraph::BIDIRECTIONAL_ASTAR,
+                        CityGraph::CONTRACTION_HIERARCHY}) {
+        graph.setEngine(engine);
+        istringstream is(queries);
+        ostringstream os;
+        HelpUtil::find_AStar_paths(&graph, is, os, 3);
+        EXPECT_EQ(os.str(), expected.str());
+    }
+}
+
+/* test that the paths of tied queries do not depend on the number of threads
+ * when they span several batches */
+TEST(CityGraphTests, HELP_UTIL_BATCH_THREADS_TEST) {
+    // a grid of equal roads, with many shortest paths between far corners
+    CityGraph graph;
+    const int side = 5;
+    for (int i = 0; i < side * side; i++) {
+        graph.insertCity("c" + to_string(i), i % side, i / side);
+    }
+    for (int i = 0; i < side * side; i++) {
+        if (i % side + 1 < side) {
+            graph.insertRoad("c" + to_string(i), "c" + to_string(i + 1));
+        }
+        if (i + side < side * side) {
+            graph.insertRoad("c" + to_string(i), "c" + to_string(i + side));
+        }
+    }
+
+    // the first batch ends with sources of many targets, searched with
+    // trees, and the second asks them one target each
+    const int batchSize = 65536;
+    const int numSources = 12;
+    ostringstream queries;
+    for (int i = 0; i < batchSize - 4 * numSources; i++) {
+        queries << "c0 c0\n";
+    }
+    for (int source = 1; source <= numSources; source++) {
+        for (int target = side * side - 4; target < side * side; target++) {
+            queries << "c" << source << " c" << target << "\n";
+        }
+    }
+    for (int source = 1; source <= numSources; source++) {
+        queries << "c" << source << " c" << side * side - 1 - source % 3
+                << "\n";
+    }
+
+    for (auto engine : {CityGraph::ASTAR, CityGraph::BIDIRECTIONAL_ASTAR}) {
+        graph.setEngine(engine);
+        istringstream serialIn(queries.str());
+        ostringstream expected;
+        HelpUtil::find_AStar_paths(&graph, serialIn, expected);
+        istringstream is(queries.str());
+        ostringstream os;
+        HelpUtil::find_AStar_paths(&graph, is, os, 16);
+        // compare line by line, the diff of whole outputs is too big
+        istringstream expectedLines(expected.str());
+        istringstream lines(os.str());
+        string expectedLine, line;
+        int numLines = 0;
+        while (getline(expectedLines, expectedLine)) {
+            ASSERT_TRUE((bool)getline(lines, line));
+            EXPECT_EQ(line, expectedLine) << "line " << numLines;
+            numLines++;
+        }
+        EXPECT_FALSE(getline(lines, line));
+        EXPECT_EQ(numLines, batchSize + numSources);
+    }
+}
+
+/* test paths walked up cached shortest path trees */
+TEST_F(SmallCityGraphFixture, PATH_TREE_TEST) {
+    graph.prepareEngine();
+    PathTreeCache cache(2);
+    SearchSpace forward;
+    SearchSpace backward;
+    vector<int> path;
+    vector<int> expected;
+    for (int start = 0; start < graph.getNumCities(); start++) {
+        for (int end = 0; end < graph.getNumCities(); end++) {
+            graph.findTreePath(start, end, path, cache);
+            graph.findPath(start, end, expected, forward, backward);
+            EXPECT_EQ(path, expected);
+        }
+    }
+    // only the 2 sources used last are kept
+    EXPECT_FALSE(cache.contains(graph.getCityId("A")));
+    EXPECT_TRUE(cache.contains(graph.getCityId("D")));
+    EXPECT_TRUE(cache.contains(graph.getCityId("E")));
+
+    // a source with many targets in a batch gets a tree
+    istringstream is("A B\nA C\nA D\nA E\nA F\nA A\nB C\n");
+    ostringstream os;
+    HelpUtil::find_AStar_paths(&graph, is, os);
+    EXPECT_EQ(os.str(),
+              "(A)-->(B)\n(A)-->(D)-->(C)\n(A)-->(D)\n(A)-->(E)\n\n\n"
+              "(B)-->(E)-->(C)\n");
+}
+
+/* test counting the effort of the searches */
+TEST_F(SmallCityGraphFixture, SEARCH_STATS_TEST) {
+    for (auto engine : {CityGraph::ASTAR, CityGraph::BIDIRECTIONAL_ASTAR,
+                        CityGraph::CONTRACTION_HIERARCHY}) {
+        graph.setEngine(engine);
+        ostringstream expected;
+        graph.find_path("A", "C", expected);
+        ostringstream os;
+        SearchStats stats;
+        graph.find_path("A", "C", os, stats);
+        // counting does not change the path
+        EXPECT_EQ(os.str(), expected.str());
+        EXPECT_GT(stats.settled, 0);
+        EXPECT_GT(stats.scanned, 0);
+        EXPECT_GE(stats.pops, stats.settled);
+        EXPECT_LE(stats.pops, stats.pushes);
+        EXPECT_GT(stats.maxFrontier, 0);
+    }
+
+    // one row per query and their total
+    graph.setEngine(CityGraph::ASTAR);
+    istringstream is("A C\nA B\n");
+    ostringstream os;
+    ostringstream statsOut;
+    HelpUtil::find_AStar_paths(&graph, is, os, 2, &statsOut);
+    EXPECT_EQ(os.str(), "(A)-->(D)-->(C)\n(A)-->(B)\n");
+    string line;
+    istringstream rows(statsOut.str());
+    getline(rows, line);
+    EXPECT_EQ(line, "query\tsettled\tscanned\tpushes\tpops\tstale_pops\t"
+                    "max_frontier");
+    getline(rows, line);
+    EXPECT_EQ(line.substr(0, 7), "A -> C\t");
+    getline(rows, line);
+    EXPECT_EQ(line.substr(0, 7), "A -> B\t");
+    getline(rows, line);
+    EXPECT_EQ(line.substr(0, 19), "total of 2 queries\t");
+}
+
+/* test alternative paths around the shortest path */
+TEST(CityGraphTests, ALTERNATIVES_TEST) {
+    // a lower route, an upper one 13% longer, and one 34% longer
+    CityGraph graph;
+    graph.insertCity("S", 0, 0);
+    graph.insertCity("T", 10, 0);
+    graph.insertCity("U1", 2, 3);
+    graph.insertCity("U2", 8, 3);
+    graph.insertCity("L1", 2, -2);
+    graph.insertCity("L2", 8, -2);
+    graph.insertCity("M", 5, 6);
+    graph.insertRoad("S", "U1");
+    graph.insertRoad("U1", "U2");
+    graph.insertRoad("U2", "T");
+    graph.insertRoad("S", "L1");
+    graph.insertRoad("L1", "L2");
+    graph.insertRoad("L2", "T");
+    graph.insertRoad("S", "M");
+    graph.insertRoad("M", "T");
+
+    istringstream is("S T\nT S\nS S\nS X\n");
+    ostringstream os;
+    HelpUtil::find_alternative_paths(&graph, is, os, 2);
+    EXPECT_EQ(os.str(),
+              "(S)-->(L1)-->(L2)-->(T)\t(S)-->(U1)-->(U2)-->(T)\n"
+              "(T)-->(L2)-->(L1)-->(S)\t(T)-->(U2)-->(U1)-->(S)\n\n\n");
+
+    // the shortest path alone
+    SearchSpace forward;
+    SearchSpace backward;
+    vector<vector<int>> paths;
+    graph.findAlternatives(graph.getCityId("S"), graph.getCityId("T"), 0,
+                           paths, forward, backward);
+    ASSERT_EQ(paths.size(), 1);
+    EXPECT_EQ(paths[0].size(), 4);
+}
+
+/* test loading a DIMACS road network */
+TEST(CityGraphTests, DIMACS_TEST) {
+    string grFile = "/tmp/test_city_graph.gr";
+    string coFile = "/tmp/test_city_graph.co";
+    ofstream gr(grFile);
+    gr << "c a square with a slow side\np sp 5 8\n"
+       << "a 1 2 10\na 2 1 10\na 2 3 10\na 3 4 10\na 4 1 50\n"
+       << "a 1 4 60\na 1 1 3\na 2 4 40";
+    gr.close();
+    ofstream co(coFile);
+    co << "p aux sp co 5\nv 1 0 0\nv 2 0 10\nv 3 10 10\nv 4 10 0\n"
+       << "v 5 50 50\n";
+    co.close();
+
+    CityGraph graph;
+    ASSERT_TRUE(graph.loadFromDimacs(grFile.c_str(), coFile.c_str()));
+    EXPECT_EQ(graph.getNumCities(), 5);
+    EXPECT_EQ(graph.getCityName(3), "4");
+    // the lighter arc 4-1 is kept, the loop dropped
+    EXPECT_EQ(graph.getRoadLength()[graph.findRoad(0, 3)], 50);
+    EXPECT_EQ(graph.findRoad(0, 0), -1);
+
+    for (auto engine : {CityGraph::ASTAR, CityGraph::BIDIRECTIONAL_ASTAR,
+                        CityGraph::CONTRACTION_HIERARCHY}) {
+        graph.setEngine(engine);
+        ostringstream os;
+        graph.find_path("1", "4", os);
+        graph.find_path("4", "2", os);
+        graph.find_path("1", "5", os);
+        EXPECT_EQ(os.str(), "(1)-->(2)-->(3)-->(4)\n(4)-->(3)-->(2)\n\n");
+    }
+
+    // arcs must refer to the declared cities
+    ofstream bad(grFile);
+    bad << "p sp 2 1\na 1 3 1\n";
+    bad.close();
+    EXPECT_FALSE(graph.loadFromDimacs(grFile.c_str(), 0));
+    remove(grFile.c_str());
+    remove(coFile.c_str());
+}
+
 /* test load function */
 TEST(CityGraphTests, LOAD_TEST) {
     string cityxyFile = "/Code/cse100_pa4/data/cityxy.txt";